@@ -3,78 +3,31 @@
 
 #include <string>
 #include <memory>
+#include "cardtable.h"
 
 class Player;
 
-// Base class for all abilities
+// An activated or triggered ability. Its effect is a bytecode program from the
+// card's definition, so one class serves every card and apply() is a direct call
+// into the effect interpreter.
 class Ability {
 protected:
     int cost;
     std::string description;
+    EffectProgram program;
+    bool triggered;
 public:
-    Ability(int cost, const std::string& desc);
-    virtual ~Ability() = default;
-    virtual void apply(Player* self, Player* target_player, int target_card_idx) = 0;
+    Ability(int cost, const std::string& desc, EffectProgram program, bool triggered);
+    explicit Ability(const CardDef& def);
+
+    // source_idx is the board slot of the minion using the ability, if any
+    void apply(Player* self, Player* target_player, int target_card_idx, int source_idx = -1) const;
     int getCost() const;
     const std::string& getDescription() const;
+    EffectProgram getProgram() const;
 };
 
-// --- Specific Ability Implementations ---
-
-class NovicePyromancerAbility : public Ability {
-public:
-    NovicePyromancerAbility();
-    void apply(Player* self, Player* target_player, int target_card_idx) override;
-};
-
-class ApprenticeSummonerAbility : public Ability {
-public:
-    ApprenticeSummonerAbility();
-    void apply(Player* self, Player* target_player, int target_card_idx) override;
-};
-
-class MasterSummonerAbility : public Ability {
-public:
-    MasterSummonerAbility();
-    void apply(Player* self, Player* target_player, int target_card_idx) override;
-};
-
-// Trigger abilities
-class BoneGolemAbility : public Ability {
-public:
-    BoneGolemAbility();
-    void apply(Player* self, Player* target_player, int target_card_idx) override;
-};
-
-class FireElementalAbility : public Ability {
-public:
-    FireElementalAbility();
-    void apply(Player* self, Player* target_player, int target_card_idx) override;
-};
-
-class PotionSellerAbility : public Ability {
-public:
-    PotionSellerAbility();
-    void apply(Player* self, Player* target_player, int target_card_idx) override;
-};
-
-// Ritual abilities
-class DarkRitualAbility : public Ability {
-public:
-    DarkRitualAbility();
-    void apply(Player* self, Player* target_player, int target_card_idx) override;
-};
-
-class AuraOfPowerAbility : public Ability {
-public:
-    AuraOfPowerAbility();
-    void apply(Player* self, Player* target_player, int target_card_idx) override;
-};
-
-class StandstillAbility : public Ability {
-public:
-    StandstillAbility();
-    void apply(Player* self, Player* target_player, int target_card_idx) override;
-};
+// Creates the ability for a card, or nullptr if it has none
+std::shared_ptr<Ability> makeAbility(const CardDef& def);
 
 #endif
@@ -0,0 +1,109 @@
+#include "actions.h"
+#include "game.h"
+#include "carddb.h"
+#include "effect.h"
+#include <climits>
+#include <stdexcept>
+
+void applyAction(Game& game, int action) {
+    Player* p = game.getActivePlayer();
+    if (action == ACTION_END) {
+        game.endTurn();
+    } else if (action < 6) {
+        p->play(action - 1);
+    } else if (action < 66) {
+        int a = action - 6;
+        p->play(a / 12, a % 12 / 6 + 1, a % 6);
+    } else if (action < 71) {
+        p->attack(action - 66);
+    } else if (action < 96) {
+        int a = action - 71;
+        p->attack(a / 5, a % 5);
+    } else if (action < 101) {
+        p->use(action - 96);
+    } else if (action < ACTION_COUNT) {
+        int a = action - 101;
+        p->use(a / 12, a % 12 / 6 + 1, a % 6);
+    } else {
+        throw std::runtime_error("Invalid action.");
+    }
+}
+
+namespace {
+
+// Minion::spendAction checks the top object's own count, not the decorated one
+bool canAct(const std::shared_ptr<Minion>& m) { return m && m->Minion::getActions() > 0; }
+
+// Adds the targeted forms of an action at base (base + (p-1)*6 + t) for the
+// slots worth aiming at: occupied ones, and rituals only if the effect can
+// use them
+void addTargets(Game& game, int base, EffectTargets targets, int* out, int& n) {
+    for (int p = 1; p <= 2; ++p) {
+        Player& player = *game.getPlayer(p);
+        if (targets.minion) {
+            for (int t = 0; t < 5; ++t) {
+                if (player.getMinions()[t]) out[n++] = base + (p - 1) * 6 + t;
+            }
+        }
+        if (targets.ritual && player.getRitual()) out[n++] = base + (p - 1) * 6 + 5;
+    }
+}
+
+} // namespace
+
+int candidateActions(Game& game, int* out) {
+    Player& me = *game.getActivePlayer();
+    const auto& mine = me.getMinions();
+    const auto& theirs = game.getNonActivePlayer()->getMinions();
+    // Outside testing mode nothing can be paid for without the magic
+    int magic = game.isTestingMode() ? INT_MAX : me.getMagic();
+    int n = 0;
+
+    out[n++] = ACTION_END;
+    const auto& hand = me.getHand();
+    for (int i = 0; i < static_cast<int>(hand.size()); ++i) {
+        if (hand[i]->getCost() > magic) continue;
+        const CardDef& def = CardDatabase::get(hand[i]->getId());
+        if (def.type == CardType::Enchantment) {
+            addTargets(game, 6 + i * 12, {true, false}, out, n);
+        } else if (def.type == CardType::Spell && def.requiresTarget) {
+            addTargets(game, 6 + i * 12, effectTargets(def.effect), out, n);
+        } else {
+            out[n++] = 1 + i;
+        }
+    }
+    for (int i = 0; i < 5; ++i) {
+        if (!canAct(mine[i])) continue;
+        out[n++] = 66 + i;
+        for (int j = 0; j < 5; ++j) {
+            if (theirs[j]) out[n++] = 71 + i * 5 + j;
+        }
+    }
+    for (int i = 0; i < 5; ++i) {
+        if (!canAct(mine[i])) continue;
+        auto ability = mine[i]->getAbility();
+        if (!ability || mine[i]->getAbilityCost() > magic) continue;
+        EffectTargets targets = effectTargets(ability->getProgram());
+        if (targets.minion || targets.ritual) {
+            addTargets(game, 101 + i * 12, targets, out, n);
+        } else {
+            out[n++] = 96 + i;
+        }
+    }
+    return n;
+}
+
+std::string actionCommand(int action) {
+    auto target = [](int a) {
+        int t = a % 6;
+        return std::to_string(a % 12 / 6 + 1) + " " + (t == 5 ? std::string("r") : std::to_string(t + 1));
+    };
+    if (action == ACTION_END) return "end";
+    if (action < 6) return "play " + std::to_string(action);
+    if (action < 66) return "play " + std::to_string((action - 6) / 12 + 1) + " " + target(action - 6);
+    if (action < 71) return "attack " + std::to_string(action - 65);
+    if (action < 96) return "attack " + std::to_string((action - 71) / 5 + 1) + " " + std::to_string((action - 71) % 5 + 1);
+    if (action < 101) return "use " + std::to_string(action - 95);
+    if (action < ACTION_COUNT) return "use " + std::to_string((action - 101) / 12 + 1) + " " + target(action - 101);
+    return "?";
+}
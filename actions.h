@@ -0,0 +1,38 @@
+#ifndef ACTIONS_H
+#define ACTIONS_H
+
+#include <string>
+
+class Game;
+
+// --- Action numbering ---
+// Every move a player can make as one integer, for agents and searches.
+// Indices i and j are 0-based hand or board slots, p is a player (1 or 2) and
+// t a target slot, 5 being p's ritual:
+//
+//     0                          end turn
+//     1 + i                      play i
+//     6 + i*12 + (p-1)*6 + t     play i p t
+//     66 + i                     attack i (the opponent)
+//     71 + i*5 + j               attack i j
+//     96 + i                     use i
+//     101 + i*12 + (p-1)*6 + t   use i p t
+constexpr int ACTION_COUNT = 161;
+constexpr int ACTION_END = 0;
+
+// Runs an action through the active player's action methods. Throws if it is
+// illegal, possibly after changing the game (e.g. spending the minion's
+// action), so searches try actions on a copy.
+void applyAction(Game& game, int action);
+
+// Writes the actions worth trying in the current position to out, which must
+// hold ACTION_COUNT, and returns how many. Skipped are actions that name an
+// empty slot, can't be paid for, use a minion without actions left, or give
+// a target to a card or ability that takes none (or the reverse). The rest
+// may still be illegal.
+int candidateActions(Game& game, int* out);
+
+// The command a player would type for an action, e.g. "play 2 1 r"
+std::string actionCommand(int action);
+
+#endif
@@ -0,0 +1,318 @@
+// Microbenchmarks for the rules and rendering hot paths. Run with 'make
+// bench', or ./sorcery_bench [results file] [name filter] from the directory
+// holding default.deck. Results are written as JSON (bench.json by default)
+// so runs can be compared, and shown as a table.
+//
+// Each benchmark is warmed up, then timed as SAMPLES samples of a batch of
+// operations sized to take at least SAMPLE_TIME. The median and p99 are of
+// the samples' ns per operation. The numbers are for whatever flags the
+// engine was built with.
+#include "game.h"
+#include "cardfactory.h"
+#include "carddb.h"
+#include "ascii_graphics.h"
+#include "packed.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int SAMPLES = 101;
+constexpr auto WARMUP = std::chrono::milliseconds(20);
+constexpr auto SAMPLE_TIME = std::chrono::microseconds(200);
+
+// Stops the compiler from discarding a result nobody reads
+template <typename T>
+void keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Accepts and drops everything, so output costs what formatting it costs
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+struct Result {
+    std::string name;
+    std::uint64_t ops = 0;
+    double median = 0; // ns per operation
+    double p99 = 0;
+    double mean = 0;
+};
+
+class Suite {
+    std::string filter;
+    std::vector<Result> results;
+
+public:
+    explicit Suite(std::string filter) : filter(std::move(filter)) {}
+
+    template <typename F>
+    void run(const std::string& name, F op) {
+        if (name.find(filter) == std::string::npos) return;
+
+        auto until = Clock::now() + WARMUP;
+        std::uint64_t batch = 0;
+        auto start = Clock::now();
+        while (Clock::now() < until) {
+            op();
+            ++batch;
+        }
+        // Size the batch from the warmup's rate
+        double per_op = std::chrono::duration<double>(Clock::now() - start).count() / std::max<std::uint64_t>(batch, 1);
+        batch = std::max<std::uint64_t>(1, std::chrono::duration<double>(SAMPLE_TIME).count() / per_op);
+
+        std::vector<double> samples;
+        for (int s = 0; s < SAMPLES; ++s) {
+            auto t = Clock::now();
+            for (std::uint64_t k = 0; k < batch; ++k) op();
+            samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t).count() / batch);
+        }
+        Result r;
+        r.name = name;
+        r.ops = batch * SAMPLES;
+        for (double x : samples) r.mean += x / SAMPLES;
+        std::sort(samples.begin(), samples.end());
+        r.median = samples[SAMPLES / 2];
+        r.p99 = samples[(SAMPLES * 99 + 99) / 100 - 1];
+        std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << r.median << std::setw(14) << r.p99 << std::endl;
+        results.push_back(r);
+    }
+
+    void write(const std::string& filename) const {
+        std::ofstream out(filename);
+        if (!out) throw std::runtime_error("Could not write " + filename);
+        out << std::fixed << std::setprecision(1) << "[\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << "  {\"name\": \"" << r.name << "\", \"ops\": " << r.ops << ", \"median_ns\": " << r.median
+                << ", \"p99_ns\": " << r.p99 << ", \"mean_ns\": " << r.mean << "}" << (i + 1 < results.size() ? "," : "")
+                << "\n";
+        }
+        out << "]\n";
+    }
+};
+
+// A seeded game past setup, with its text thrown away
+struct Table {
+    NullBuffer buffer;
+    std::ostream out{&buffer};
+    Game game;
+
+    Table() : game("default.deck", "default.deck", "", false, false, out, out) {
+        game.seed(1);
+        game.setup("Player 1", "Player 2");
+    }
+
+    Player& player(int id) { return *game.getPlayer(id); }
+};
+
+std::shared_ptr<Minion> minion(CardId id, Player& owner) {
+    return std::static_pointer_cast<Minion>(CardFactory::createCard(id, &owner));
+}
+
+// Fills both boards and gives each player a ritual, with a trigger of every kind on the table
+void fillBoards(Table& t) {
+    const CardId mine[] = {CardId::BoneGolem, CardId::FireElemental, CardId::PotionSeller, CardId::NovicePyromancer,
+                           CardId::MasterSummoner};
+    for (int p = 1; p <= 2; ++p) {
+        auto& minions = t.player(p).getMinions();
+        for (int i = 0; i < 5; ++i) minions[i] = minion(mine[i], t.player(p));
+    }
+    t.player(1).setRitual(std::static_pointer_cast<Ritual>(CardFactory::createCard(CardId::DarkRitual, &t.player(1))));
+    t.player(2).setRitual(std::static_pointer_cast<Ritual>(CardFactory::createCard(CardId::AuraOfPower, &t.player(2))));
+}
+
+void cardBenchmarks(Suite& suite) {
+    Table t;
+    Player& p = t.player(1);
+    const std::pair<const char*, CardId> kinds[] = {{"minion", CardId::EarthElemental},
+                                                    {"triggered minion", CardId::FireElemental},
+                                                    {"spell", CardId::Blizzard},
+                                                    {"ritual", CardId::DarkRitual},
+                                                    {"enchantment", CardId::GiantStrength}};
+    for (const auto& [kind, id] : kinds) {
+        suite.run(std::string("CardFactory::createCard/") + kind, [&, id = id] { keep(CardFactory::createCard(id, &p)); });
+    }
+    suite.run("CardFactory::createCard/by name", [&] { keep(CardFactory::createCard("Earth Elemental", &p)); });
+
+    suite.run("Player::loadDeck", [&] {
+        p.getDeck().clear();
+        p.loadDeck("default.deck");
+    });
+
+    p.getDeck().clear();
+    p.loadDeck("default.deck");
+    suite.run("Player::shuffleDeck", [&] { p.shuffleDeck(); });
+
+    // Refilling the deck and emptying the hand are part of the cost
+    const std::vector<CardId> full = p.getDeck();
+    suite.run("Player::drawCard", [&] {
+        if (p.getHand().size() >= 5) p.getHand().clear();
+        if (p.getDeck().empty()) p.getDeck() = full;
+        p.drawCard();
+    });
+
+    auto vanilla = minion(CardId::AirElemental, p);
+    suite.run("Player::addMinion+removeMinion", [&] {
+        p.addMinion(vanilla);
+        p.removeMinion(0, false);
+    });
+}
+
+void triggerBenchmarks(Suite& suite) {
+    Table t;
+    fillBoards(t);
+    Game& g = t.game;
+    // Not on the board, so effects aimed at it find nothing
+    auto outsider = minion(CardId::AirElemental, t.player(1));
+    auto recharge = [&] {
+        t.player(1).getRitual()->setCharges(100);
+        t.player(2).getRitual()->setCharges(100);
+    };
+    suite.run("Game::execute_triggers/start of turn", [&] {
+        recharge();
+        g.notifyTurnStart();
+    });
+    suite.run("Game::execute_triggers/end of turn", [&] { g.notifyTurnEnd(); });
+    suite.run("Game::execute_triggers/minion enters", [&] {
+        recharge();
+        g.notifyMinionEnters(outsider);
+    });
+    suite.run("Game::execute_triggers/minion leaves", [&] { g.notifyMinionLeaves(outsider); });
+}
+
+void enchantmentBenchmarks(Suite& suite) {
+    Table t;
+    Player& p = t.player(1);
+    for (int depth : {0, 1, 2, 4, 8}) {
+        std::shared_ptr<Minion> top = minion(CardId::NovicePyromancer, p);
+        for (int k = 0; k < depth; ++k) {
+            auto e = std::static_pointer_cast<Enchantment>(CardFactory::createCard(CardId::GiantStrength, &p));
+            e->setComponent(top);
+            top = e;
+        }
+        suite.run("Enchantment getters/depth " + std::to_string(depth), [&, top] {
+            keep(top->getAttack() + top->getDefense() + top->getActions() + top->getAbilityCost());
+            keep(top->getAbility());
+        });
+    }
+}
+
+// Checks first that a position far past anything the default deck reaches
+// comes back from the packed format as it went in: hundreds of cards in deck
+// and graveyard, a deep enchantment stack and numbers past a byte
+void packBenchmarks(Suite& suite) {
+    Table t;
+    fillBoards(t);
+    for (int p = 1; p <= 2; ++p) {
+        Player& player = t.player(p);
+        std::vector<CardId> deck;
+        for (int k = 0; k < 10; ++k) deck.insert(deck.end(), player.getDeck().begin(), player.getDeck().end());
+        player.getDeck() = deck;
+        player.setMagic(300);
+        player.setLife(-2);
+        for (int k = 0; k < 80; ++k) player.getGraveyard().push_back(minion(CardId::AirElemental, player));
+        player.getRitual()->setCharges(1000);
+    }
+    std::shared_ptr<Minion> top = t.player(1).getMinions()[0];
+    top->setAttack(500);
+    for (int k = 0; k < 12; ++k) {
+        auto e = std::static_pointer_cast<Enchantment>(CardFactory::createCard(CardId::GiantStrength, &t.player(1)));
+        e->setComponent(top);
+        top = e;
+    }
+    t.player(1).getMinions()[0] = top;
+
+    PackedState big = packState(t.game);
+    Table copy;
+    unpackState(big, copy.game);
+    if (packState(copy.game).bytes != big.bytes || copy.player(2).getDeck() != t.player(2).getDeck() ||
+        copy.player(1).getMinions()[0]->getAttack() != top->getAttack()) {
+        throw std::runtime_error("Packed position did not survive a round trip");
+    }
+
+    Table start;
+    PackedState small = packState(start.game);
+    suite.run("packState/start", [&] { keep(packState(start.game)); });
+    suite.run("unpackState/start", [&] { unpackState(small, copy.game); });
+    suite.run("packState/" + std::to_string(big.bytes.size()) + " bytes", [&] { keep(packState(t.game)); });
+    suite.run("unpackState/" + std::to_string(big.bytes.size()) + " bytes", [&] { unpackState(big, copy.game); });
+}
+
+void renderBenchmarks(Suite& suite) {
+    suite.run("display_minion_no_ability", [] { keep(display_minion_no_ability("Earth Elemental", 3, 4, 4)); });
+    suite.run("display_minion_triggered_ability", [] {
+        keep(display_minion_triggered_ability("Fire Elemental", 2, 2, 2,
+                                              "Whenever an opponent's minion enters play, deal 1 damage to it"));
+    });
+    suite.run("display_minion_activated_ability", [] {
+        keep(display_minion_activated_ability("Novice Pyromancer", 1, 0, 1, 1, "Deal 1 damage to target minion"));
+    });
+    suite.run("display_ritual", [] {
+        keep(display_ritual("Dark Ritual", 0, 1, "At the start of your turn, gain 1 magic", 5));
+    });
+    suite.run("display_spell", [] { keep(display_spell("Blizzard", 3, "Deal 2 damage to all minions")); });
+    suite.run("display_enchantment_attack_defence",
+              [] { keep(display_enchantment_attack_defence("Giant Strength", 1, "", "+2", "+2")); });
+    suite.run("display_enchantment",
+              [] { keep(display_enchantment("Haste", 1, "Enchanted minion gains +1 action each turn")); });
+    suite.run("display_player_card", [] { keep(display_player_card(1, "Player 1", 20, 3)); });
+
+    Table t;
+    fillBoards(t);
+    suite.run("Board::display", [&] { t.game.getBoard()->display(); });
+}
+
+// Whole games through the resumable loop, board display included: each turn
+// the player plays and attacks with everything they can, then ends it
+void gameBenchmarks(Suite& suite) {
+    std::vector<std::string> turn = {"play 1", "play 1", "play 1", "attack 1", "attack 2", "attack 3",
+                                     "attack 4", "attack 5", "end"};
+    NullBuffer buffer;
+    std::ostream out(&buffer);
+    unsigned seed = 0;
+    suite.run("Game/scripted game", [&] {
+        Game game("default.deck", "default.deck", "", false, false, out, out);
+        game.seed(++seed);
+        game.start();
+        game.resume("Player 1");
+        game.resume("Player 2");
+        for (int line = 0; !game.isOver() && line < 1000; ++line) game.resume(turn[line % turn.size()]);
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string output = argc > 1 ? argv[1] : "bench.json";
+    Suite suite(argc > 2 ? argv[2] : "");
+    try {
+        std::cout << std::left << std::setw(48) << "benchmark" << std::right << std::setw(14) << "median ns"
+                  << std::setw(14) << "p99 ns" << std::endl;
+        cardBenchmarks(suite);
+        triggerBenchmarks(suite);
+        enchantmentBenchmarks(suite);
+        packBenchmarks(suite);
+        renderBenchmarks(suite);
+        gameBenchmarks(suite);
+        suite.write(output);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -10,15 +10,16 @@ class Game;
 class Player;
 class Card;
 class Minion;
+struct BoardSnapshot;
 
+// Shows the board, hands and minions, drawing them straight to the game's
+// output or, when the game has a Renderer, handing snapshots to its thread
 class Board {
     Game* game; // Raw pointer, does not own
 
-    // Helper to print a row of cards
-    void print_card_row(const std::vector<card_template_t>& cards);
-
 public:
     Board(Game* game);
+    BoardSnapshot snapshot() const;
     void display();
     void displayHand(int player_id);
     void inspectMinion(int player_id, int minion_idx);
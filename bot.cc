@@ -0,0 +1,154 @@
+#include "bot.h"
+#include "actions.h"
+#include "game.h"
+#include "packed.h"
+#include "profile.h"
+#include "solver.h"
+#include <chrono>
+
+namespace {
+
+// playOut ends the turn for a bot still acting after this many actions. The
+// greedy bot only acts to raise its score, so it ends its own turns long
+// before; this keeps a bug from hanging a whole tournament.
+constexpr int MAX_ACTIONS_PER_TURN = 64;
+
+} // namespace
+
+GreedyBot::GreedyBot() : work(std::make_unique<ScratchGame>()) {}
+
+GreedyBot::~GreedyBot() {}
+
+int GreedyBot::choose(Game& game) {
+    Game& scratch = work->get(game.isTestingMode());
+    int me = game.getActivePlayer()->getPlayerId();
+    PackedState position = packState(game);
+    int moves[ACTION_COUNT];
+    int n = candidateActions(game, moves);
+
+    int best = ACTION_END;
+    int best_score = materialScore(game, me);
+    for (int k = 0; k < n; ++k) {
+        if (moves[k] == ACTION_END) continue;
+        unpackState(position, scratch);
+        try {
+            applyAction(scratch, moves[k]);
+            scratch.removeDeadMinions();
+        } catch (const std::exception&) {
+            continue;
+        }
+        if (int winner = scratch.getWinner()) {
+            if (winner == me) return moves[k];
+            continue;
+        }
+        int score = materialScore(scratch, me);
+        if (score > best_score) {
+            best_score = score;
+            best = moves[k];
+        }
+    }
+    return best;
+}
+
+AnytimeBot::AnytimeBot(double budget, int max_depth)
+    : solver(std::make_unique<Solver>(std::size_t{1} << 18)), budget(budget), max_depth(max_depth),
+      depths(max_depth + 1), ponder_work(std::make_unique<ScratchGame>()), ponder_depths(max_depth + 1) {
+    solver->setCancelFlag(&stop_pondering);
+}
+
+AnytimeBot::~AnytimeBot() { stopPondering(); }
+
+void AnytimeBot::ponder(Game& game, int side) {
+    stopPondering();
+    if (!pondering) return;
+    // The snapshot is all the thread gets
+    PackedState position = packState(game);
+    bool testing = game.isTestingMode();
+    ponderer = std::thread([this, position, side, testing] {
+        auto start = std::chrono::steady_clock::now();
+        Game& scratch = ponder_work->get(testing);
+        unpackState(position, scratch);
+        try {
+            applyAction(scratch, ACTION_END);
+            scratch.removeDeadMinions();
+        } catch (const std::exception&) {
+            return;
+        }
+        if (scratch.getWinner()) return;
+        // Until stopped, or the deepest search is done
+        SolveResult result = solver->solve(packState(scratch), side, testing, max_depth, 1e6);
+        ++ponders;
+        ponder_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++ponder_depths[result.depth];
+    });
+}
+
+void AnytimeBot::stopPondering() {
+    if (!ponderer.joinable()) return;
+    stop_pondering = true;
+    ponderer.join();
+    stop_pondering = false;
+}
+
+void AnytimeBot::setPondering(bool on) {
+    pondering = on;
+    if (!on) stopPondering();
+}
+
+int AnytimeBot::choose(Game& game) {
+    auto start = std::chrono::steady_clock::now();
+    stopPondering();
+    int move = greedy.choose(game);
+    int depth = 0;
+    // A twentieth of the budget is kept back for the search to wind down
+    double left = 0.95 * budget - std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (left > 0) {
+        SolveResult result = solver->solve(game, max_depth, left);
+        if (result.best >= 0) {
+            move = result.best;
+            depth = result.depth;
+        }
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    profile::record(Phase::Think, ns);
+    ++moves;
+    if (ns > budget * 1e9) ++late;
+    ++depths[depth];
+    return move;
+}
+
+void AnytimeBot::report(std::ostream& out) const {
+    out << "Bot: " << moves << " moves, " << late << " over " << budget * 1000 << "ms; by depth reached:";
+    for (std::size_t d = 0; d < depths.size(); ++d) {
+        if (depths[d]) out << ' ' << d << ": " << depths[d];
+    }
+    out << '\n';
+    if (!ponders) return;
+    out << "Pondered " << ponders << " times for " << ponder_seconds << "s; by depth reached:";
+    for (std::size_t d = 0; d < ponder_depths.size(); ++d) {
+        if (ponder_depths[d]) out << ' ' << d << ": " << ponder_depths[d];
+    }
+    out << '\n';
+}
+
+int playOut(Game& game, GreedyBot& bot, int max_turns) {
+    int actions = 0;
+    for (int turns = 0; turns < max_turns;) {
+        int action = ++actions > MAX_ACTIONS_PER_TURN ? ACTION_END : bot.choose(game);
+        try {
+            applyAction(game, action);
+            game.removeDeadMinions();
+        } catch (const std::exception&) {
+            // The scratch game said it was legal; end the turn rather than loop
+            action = ACTION_END;
+            game.endTurn();
+        }
+        if (int winner = game.getWinner()) return winner;
+        if (action == ACTION_END) {
+            ++turns;
+            actions = 0;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+class Game;
+class ScratchGame;
+class Solver;
+
+// --- Bots ---
+// Computer players for simulations, picking actions (see actions.h) for
+// whichever player is active.
+
+// The greedy bot tries every candidate action on a scratch copy of the
+// position and plays the one that leaves the best material score (see
+// solver.h), winning moves first. It ends the turn once nothing beats the
+// position as it stands. No lookahead past the current action, so a move
+// costs a few dozen unpacks and a game a few milliseconds: cheap enough to
+// play thousands of games for deck evaluation.
+class GreedyBot {
+    std::unique_ptr<ScratchGame> work;
+
+public:
+    GreedyBot();
+    ~GreedyBot();
+
+    // The action the active player should take next; always legal, "end" if
+    // nothing else is
+    int choose(Game& game);
+};
+
+// The anytime bot answers within a fixed time, whatever the board. It has the
+// greedy bot's move ready before it starts searching, then deepens the
+// solver's search (see solver.h) a turn at a time until the deadline, and
+// plays the best move of the deepest search it finished. The solver checks
+// the clock every few nodes and stops the search a little before the budget
+// runs out, so moves come in on time. Every move's think time goes to the Think histogram
+// (see profile.h), and the bot counts the depth each move reached.
+//
+// While the opponent thinks, the bot can ponder on a thread of its own. It
+// works from a packed snapshot, so the game itself is never read there, and
+// searches the position the opponent would leave by ending their turn now.
+// The solver's table is all the tree there is, and it is kept: each command
+// the opponent plays re-roots the ponder at the new turn-end position, and
+// once they end their turn the bot's own search finds the depths already
+// searched from exactly where it stands, and goes on from there.
+class AnytimeBot {
+    GreedyBot greedy;
+    std::unique_ptr<Solver> solver;
+    double budget; // Seconds per move
+    int max_depth;
+
+    std::uint64_t moves = 0;
+    std::uint64_t late = 0; // Moves that took longer than the budget
+    std::vector<std::uint64_t> depths; // Moves by depth reached, 0 for the greedy move
+
+    std::unique_ptr<ScratchGame> ponder_work;
+    std::thread ponderer;
+    std::atomic<bool> stop_pondering{false}; // Cancels the ponderer's search
+    bool pondering = true;
+    // Written by the ponderer, read once it has been joined
+    std::uint64_t ponders = 0;
+    double ponder_seconds = 0;
+    std::vector<std::uint64_t> ponder_depths; // Ponders by depth reached
+
+public:
+    explicit AnytimeBot(double budget, int max_depth = 16);
+    ~AnytimeBot();
+
+    // Stops any pondering first
+    int choose(Game& game);
+
+    // Starts searching in the background for side, the bot's seat, while the
+    // other side is to move, until stopPondering() or choose(). Does nothing
+    // if pondering is off.
+    void ponder(Game& game, int side);
+    void stopPondering();
+    void setPondering(bool on);
+
+    // Moves made, how many were late and how deep they and the ponders
+    // searched
+    void report(std::ostream& out) const;
+};
+
+// Plays a game that has been set up with the bot on both sides until someone
+// wins or max_turns turns have been played. Returns the winner, or 0 for a
+// game that ran out of turns. The bot's scratch game is kept between calls.
+int playOut(Game& game, GreedyBot& bot, int max_turns = 200);
+
+#endif
@@ -1,15 +1,40 @@
 #include "card.h"
 #include "player.h"
+#include "memstats.h"
 #include <stdexcept>
 
 // Card constructor
 Card::Card(const std::string& name, int cost, Player* owner, CardType type)
     : name(name), cost(cost), owner(owner), type(type) {}
 
+card_template_t drawFace(const CardFace& f) {
+    MEM_CATEGORY(MemCategory::Render);
+    switch (f.layout) {
+        case CardFace::Layout::Minion:
+            return display_minion_no_ability(f.name, f.cost, f.attack, f.defense);
+        case CardFace::Layout::TriggeredMinion:
+            return display_minion_triggered_ability(f.name, f.cost, f.attack, f.defense, f.desc);
+        case CardFace::Layout::ActivatedMinion:
+            return display_minion_activated_ability(f.name, f.cost, f.attack, f.defense, f.abilityCost, f.desc);
+        case CardFace::Layout::Ritual:
+            return display_ritual(f.name, f.cost, f.abilityCost, f.desc, f.charges);
+        case CardFace::Layout::Spell:
+            return display_spell(f.name, f.cost, f.desc);
+        case CardFace::Layout::StatEnchantment:
+            return display_enchantment_attack_defence(f.name, f.cost, f.desc, f.attackText, f.defenseText);
+        case CardFace::Layout::Enchantment:
+            return display_enchantment(f.name, f.cost, f.desc);
+    }
+    return CARD_TEMPLATE_BORDER;
+}
+
+card_template_t Card::render() const { return drawFace(face()); }
+
 // Getters
 const std::string& Card::getName() const { return name; }
 int Card::getCost() const { return cost; }
 CardType Card::getType() const { return type; }
+CardId Card::getId() const { return id; }
 Player* Card::getOwner() const { return owner; } // <-- IMPLEMENTED GETTER
 
 // Default play implementation (for cards that don't need a target)
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <memory>
+#include <cstdint>
 #include "ascii_graphics.h"
 
 class Player;
@@ -24,6 +25,59 @@ enum class TriggerType {
     None
 };
 
+// Enum identifying each card in the base set, in CARD_TABLE order (see cardtable.h)
+enum class CardId : std::uint16_t {
+    AirElemental,
+    EarthElemental,
+    BoneGolem,
+    FireElemental,
+    PotionSeller,
+    NovicePyromancer,
+    ApprenticeSummoner,
+    MasterSummoner,
+    Banish,
+    Unsummon,
+    Recharge,
+    Disenchant,
+    RaiseDead,
+    Blizzard,
+    GiantStrength,
+    Enrage,
+    Haste,
+    MagicFatigue,
+    Silence,
+    DarkRitual,
+    AuraOfPower,
+    Standstill,
+    Invalid = 0xFFFF
+};
+
+// Everything needed to draw a card, captured by value so it can be drawn
+// after the card itself has changed or gone (see renderer.h)
+struct CardFace {
+    enum class Layout : std::uint8_t {
+        Minion,             // No ability
+        TriggeredMinion,    // desc is the trigger
+        ActivatedMinion,    // desc and abilityCost are the activated ability
+        Ritual,             // abilityCost is the activation cost
+        Spell,
+        StatEnchantment,    // attackText and defenseText show the modifiers
+        Enchantment
+    };
+    Layout layout = Layout::Minion;
+    std::string name;
+    int cost = 0;
+    int attack = 0;
+    int defense = 0;
+    int abilityCost = 0;
+    int charges = 0;
+    std::string desc;
+    std::string attackText;
+    std::string defenseText;
+};
+
+card_template_t drawFace(const CardFace& face);
+
 // Abstract base class for all cards
 class Card {
 protected:
@@ -31,13 +85,15 @@ protected:
     int cost;
     Player* owner;
     CardType type;
+    CardId id = CardId::Invalid;
 
 public:
     Card(const std::string& name, int cost, Player* owner, CardType type);
     virtual ~Card() = default;
 
     // Pure virtual methods that all cards must implement
-    virtual card_template_t render() const = 0;
+    virtual CardFace face() const = 0;
+    card_template_t render() const; // Draws face()
     
     // Virtual methods for playing cards, with and without targets
     virtual void play(Player* p);
@@ -47,6 +103,7 @@ public:
     const std::string& getName() const;
     int getCost() const;
     CardType getType() const;
+    CardId getId() const;
     Player* getOwner() const; // <-- ADDED GETTER
 };
 
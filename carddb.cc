@@ -0,0 +1,528 @@
+#include "carddb.h"
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// --- Binary database layout ---
+// header | BinaryCard[cardCount] | effect bytecode | NUL-terminated strings
+constexpr char BINARY_MAGIC[8] = {'S', 'O', 'R', 'C', 'D', 'B', '\0', '\1'};
+constexpr std::uint32_t BINARY_VERSION = 2;
+
+struct BinaryHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t cardCount;
+    std::uint32_t codeBytes;
+    std::uint32_t stringBytes;
+};
+
+struct BinaryCard {
+    std::uint32_t name;        // Offsets into the string section
+    std::uint32_t desc;
+    std::uint32_t effectBegin; // Offset into the bytecode section
+    std::uint16_t effectSize;
+    std::uint8_t type;
+    std::uint8_t trigger;
+    std::int16_t cost;
+    std::int16_t attack;
+    std::int16_t defense;
+    std::int16_t abilityCost;
+    std::int16_t charges;
+    std::int16_t activationCost;
+    std::uint8_t requiresTarget;
+    std::uint8_t pad[3];
+};
+static_assert(sizeof(BinaryHeader) == 24 && sizeof(BinaryCard) == 32, "Binary card database layout changed");
+
+// Whether a card's effect acts on the target it is played or used on
+bool usesTarget(const CardDef& def) {
+    EffectTargets targets = effectTargets(def.effect);
+    return targets.minion || targets.ritual;
+}
+
+// All registered definitions plus the storage their strings and effects point into.
+// Definitions live in a deque so references handed out stay valid as cards are added.
+struct Registry {
+    std::deque<CardDef> defs;
+    std::unordered_map<std::string_view, CardId> byName;
+    std::vector<std::unique_ptr<char[]>> texts;         // Text databases, parsed in place
+    std::vector<std::unique_ptr<std::uint8_t[]>> code;  // Bytecode compiled from text, or rebased
+    std::vector<std::pair<void*, std::size_t>> maps;    // Binary databases, mapped for the process lifetime
+
+    Registry() {
+        for (const CardDef& def : CARD_TABLE) {
+            if (!verifyEffect(def.effect).empty()) {
+                throw std::logic_error(std::string("Malformed effect in CARD_TABLE: ") + def.name);
+            }
+            if (def.type == CardType::Spell && def.requiresTarget != usesTarget(def)) {
+                throw std::logic_error(std::string("Spell target flag doesn't match its effect in CARD_TABLE: ") +
+                                       def.name);
+            }
+            defs.push_back(def);
+            byName.emplace(def.name, def.id);
+        }
+    }
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+// Registers a definition. Returns false if the name is already taken.
+bool addCard(Registry& reg, CardDef def) {
+    if (reg.defs.size() >= static_cast<std::size_t>(CardId::Invalid)) {
+        throw std::runtime_error("Too many cards in card databases");
+    }
+    def.id = static_cast<CardId>(reg.defs.size());
+    if (!reg.byName.emplace(def.name, def.id).second) return false;
+    reg.defs.push_back(def);
+    return true;
+}
+
+// Calls f with a pointer to the card operand of every Summon in a verified program
+template <typename F>
+void forEachSummon(EffectProgram program, F f) {
+    for (std::size_t pc = 0; pc < program.size;) {
+        EffectOp o = static_cast<EffectOp>(program.code[pc]);
+        if (o == EffectOp::Summon) f(const_cast<std::uint8_t*>(program.code + pc + 1));
+        pc += 1 + operandBytes(o);
+    }
+}
+
+// Checks what the parsers cannot see locally: summons name real minions,
+// effects only appear where something can fire them, and a spell takes a
+// target exactly when its effect uses one
+void validate(const Registry& reg, std::size_t first, const std::string& where) {
+    for (std::size_t i = first; i < reg.defs.size(); ++i) {
+        const CardDef& def = reg.defs[i];
+        auto fail = [&](const char* what) {
+            throw std::runtime_error(where + ": card '" + def.name + "' " + what);
+        };
+        if (def.type == CardType::Ritual && def.trigger == TriggerType::None) fail("is a ritual without a trigger");
+        if (def.type == CardType::Spell && def.trigger != TriggerType::None) fail("is a spell with a trigger");
+        if (def.type == CardType::Minion && !def.effect.empty() && !hasAbility(def)) {
+            fail("has effects but no ability or trigger");
+        }
+        std::string problem = verifyEffect(def.effect);
+        if (!problem.empty()) fail(("has a malformed effect: " + problem).c_str());
+        if (def.type == CardType::Spell && def.requiresTarget != usesTarget(def)) {
+            fail(def.requiresTarget ? "takes a target its effect never uses"
+                                    : "has an effect that needs a target, but takes none");
+        }
+        forEachSummon(def.effect, [&](std::uint8_t* card) {
+            std::size_t id = card[0] | (card[1] << 8);
+            if (id >= reg.defs.size() || reg.defs[id].type != CardType::Minion) {
+                fail("summons something that is not a minion");
+            }
+        });
+    }
+}
+
+// --- Text format ---
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && isSpace(s.front())) s.remove_prefix(1);
+    while (!s.empty() && isSpace(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+// Splits off the first whitespace-separated token
+std::string_view nextToken(std::string_view& s) {
+    s = trim(s);
+    std::size_t n = 0;
+    while (n < s.size() && !isSpace(s[n])) ++n;
+    std::string_view tok = s.substr(0, n);
+    s.remove_prefix(n);
+    return tok;
+}
+
+class TextParser {
+    Registry& reg;
+    std::string filename;
+    int line = 0;
+
+    bool inCard = false;
+    CardDef card{};
+    bool typeSet = false;
+    std::vector<std::uint8_t> code;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges; // Bytecode range of each card, in order
+    std::vector<std::pair<std::size_t, std::string_view>> summons; // Card operand offset, minion name
+
+    [[noreturn]] void fail(const std::string& msg) const {
+        throw std::runtime_error(filename + ":" + std::to_string(line) + ": " + msg);
+    }
+
+    int parseInt(std::string_view s) const {
+        int v = 0;
+        auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+        if (ec != std::errc() || ptr != s.data() + s.size()) fail("expected a number, got '" + std::string(s) + "'");
+        return v;
+    }
+
+    // Bytecode operands are a single byte
+    std::uint8_t parseOperand(std::string_view s, int lo, int hi) const {
+        int v = parseInt(s);
+        if (v < lo || v > hi) fail("number out of range");
+        return static_cast<std::uint8_t>(v);
+    }
+    std::uint8_t parseSigned(std::string_view s) const { return parseOperand(s, -128, 127); }
+
+    // The value of a key, NUL-terminated in place so it can be used as a C string
+    static const char* terminate(std::string_view value) {
+        char* p = const_cast<char*>(value.data());
+        p[value.size()] = '\0';
+        return p;
+    }
+
+    // Emits the Select that every per-minion effect starts with
+    void emitSelect(std::string_view s) {
+        EffectScope sc;
+        if (s == "target") sc = EffectScope::Target;
+        else if (s == "own-target") sc = EffectScope::OwnTarget;
+        else if (s == "enemy-target") sc = EffectScope::EnemyTarget;
+        else if (s == "own") sc = EffectScope::Own;
+        else if (s == "enemy") sc = EffectScope::Enemy;
+        else if (s == "all") sc = EffectScope::All;
+        else if (s == "self") sc = EffectScope::Self;
+        else fail("unknown effect scope '" + std::string(s) + "'");
+        code.push_back(op(EffectOp::Select));
+        code.push_back(scope(sc));
+    }
+
+    // Compiles one effect line to bytecode
+    void parseEffect(std::string_view s) {
+        std::string_view name = nextToken(s);
+        if (name == "damage") {
+            emitSelect(nextToken(s));
+            code.push_back(op(EffectOp::Damage));
+            code.push_back(parseSigned(nextToken(s)));
+        } else if (name == "buff") {
+            emitSelect(nextToken(s));
+            code.push_back(op(EffectOp::Buff));
+            code.push_back(parseSigned(nextToken(s)));
+            code.push_back(parseSigned(nextToken(s)));
+        } else if (name == "destroy" || name == "bounce" || name == "disenchant") {
+            emitSelect(nextToken(s));
+            code.push_back(op(name == "destroy" ? EffectOp::Destroy
+                              : name == "bounce" ? EffectOp::Bounce : EffectOp::Disenchant));
+        } else if (name == "summon") {
+            std::uint8_t count = parseOperand(nextToken(s), 1, 255);
+            std::string_view card = trim(s);
+            if (card.empty()) fail("summon needs a card name");
+            code.push_back(op(EffectOp::Summon));
+            summons.emplace_back(code.size(), card);
+            code.insert(code.end(), {0, 0, count});
+            s = {};
+        } else if (name == "resurrect") {
+            code.push_back(op(EffectOp::Resurrect));
+        } else if (name == "charge" || name == "magic") {
+            code.push_back(op(name == "charge" ? EffectOp::GainCharges : EffectOp::GainMagic));
+            code.push_back(parseSigned(nextToken(s)));
+        } else {
+            fail("unknown effect '" + std::string(name) + "'");
+        }
+        if (!trim(s).empty()) fail("unexpected text after effect");
+    }
+
+    void parseField(std::string_view key, std::string_view value) {
+        if (key == "type") {
+            if (value == "minion") card.type = CardType::Minion;
+            else if (value == "spell") card.type = CardType::Spell;
+            else if (value == "ritual") card.type = CardType::Ritual;
+            else fail("unsupported card type '" + std::string(value) + "'");
+            typeSet = true;
+        } else if (key == "cost") {
+            card.cost = parseInt(value);
+        } else if (key == "attack") {
+            card.attack = parseInt(value);
+        } else if (key == "defense") {
+            card.defense = parseInt(value);
+        } else if (key == "ability") {
+            card.abilityCost = parseInt(value);
+            if (card.abilityCost < 1) fail("activated abilities must cost at least 1");
+        } else if (key == "trigger") {
+            if (value == "enters") card.trigger = TriggerType::MinionEnters;
+            else if (value == "leaves") card.trigger = TriggerType::MinionLeaves;
+            else if (value == "start") card.trigger = TriggerType::StartOfTurn;
+            else if (value == "end") card.trigger = TriggerType::EndOfTurn;
+            else fail("unknown trigger '" + std::string(value) + "'");
+        } else if (key == "charges") {
+            card.charges = parseInt(value);
+        } else if (key == "activation") {
+            card.activationCost = parseInt(value);
+        } else if (key == "target") {
+            if (value == "yes") card.requiresTarget = true;
+            else if (value == "no") card.requiresTarget = false;
+            else fail("target must be 'yes' or 'no'");
+        } else if (key == "desc") {
+            card.desc = terminate(value);
+        } else if (key == "effect") {
+            parseEffect(value);
+        } else {
+            fail("unknown key '" + std::string(key) + "'");
+        }
+    }
+
+    void beginCard(std::string_view name) {
+        endCard();
+        if (name.empty()) fail("card name is empty");
+        card = CardDef{};
+        card.name = terminate(name);
+        card.desc = "";
+        card.trigger = TriggerType::None;
+        typeSet = false;
+        inCard = true;
+        ranges.emplace_back(code.size(), code.size());
+    }
+
+    void endCard() {
+        if (!inCard) return;
+        if (!typeSet) fail(std::string("card '") + card.name + "' has no type");
+        if (code.size() > ranges.back().first) code.push_back(op(EffectOp::Halt));
+        if (code.size() - ranges.back().first > 0xFFFF) fail("effect is too long");
+        ranges.back().second = code.size();
+        if (!addCard(reg, card)) fail(std::string("duplicate card name '") + card.name + "'");
+        inCard = false;
+    }
+
+public:
+    TextParser(Registry& reg, const std::string& filename) : reg(reg), filename(filename) {}
+
+    // Parses a NUL-terminated buffer owned by the registry
+    void parse(char* buf, std::size_t len) {
+        std::size_t first = reg.defs.size();
+        const char* p = buf;
+        const char* end = buf + len;
+        while (p < end) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!nl) nl = end;
+            std::string_view text = trim(std::string_view(p, nl - p));
+            p = nl + 1;
+            ++line;
+
+            if (text.empty() || text.front() == '#') continue;
+            if (text.front() == '[') {
+                if (text.back() != ']') fail("expected ']' after card name");
+                beginCard(trim(text.substr(1, text.size() - 2)));
+                continue;
+            }
+            if (!inCard) fail("field outside of a card");
+            std::size_t eq = text.find('=');
+            if (eq == std::string_view::npos) fail("expected 'key = value'");
+            parseField(trim(text.substr(0, eq)), trim(text.substr(eq + 1)));
+        }
+        endCard();
+
+        for (auto& [idx, name] : summons) {
+            auto it = reg.byName.find(name);
+            if (it == reg.byName.end()) {
+                throw std::runtime_error(filename + ": summon of unknown card '" + std::string(name) + "'");
+            }
+            std::uint16_t id = static_cast<std::uint16_t>(it->second);
+            code[idx] = id & 0xFF;
+            code[idx + 1] = id >> 8;
+        }
+
+        auto storage = std::make_unique<std::uint8_t[]>(code.size());
+        std::copy(code.begin(), code.end(), storage.get());
+        for (std::size_t i = 0; i < ranges.size(); ++i) {
+            CardDef& def = reg.defs[first + i];
+            def.effect.code = storage.get() + ranges[i].first;
+            def.effect.size = static_cast<std::uint16_t>(ranges[i].second - ranges[i].first);
+        }
+        reg.code.push_back(std::move(storage));
+        validate(reg, first, filename);
+    }
+};
+
+void loadText(Registry& reg, const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("Could not open card database " + filename);
+    std::size_t len = static_cast<std::size_t>(file.tellg());
+    auto buf = std::make_unique<char[]>(len + 1);
+    file.seekg(0);
+    file.read(buf.get(), len);
+    buf[len] = '\0';
+    char* data = buf.get();
+    reg.texts.push_back(std::move(buf));
+    TextParser(reg, filename).parse(data, len);
+}
+
+// --- Binary format ---
+
+void loadBinary(Registry& reg, const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Could not open card database " + filename);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not stat card database " + filename);
+    }
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) throw std::runtime_error("Could not map card database " + filename);
+    reg.maps.emplace_back(map, size);
+
+    const char* base = static_cast<const char*>(map);
+    const auto* header = reinterpret_cast<const BinaryHeader*>(base);
+    auto corrupt = [&filename]() { return std::runtime_error(filename + ": corrupt card database"); };
+    if (size < sizeof(BinaryHeader) || header->version != BINARY_VERSION) throw corrupt();
+    std::size_t cardsAt = sizeof(BinaryHeader);
+    std::size_t codeAt = cardsAt + std::size_t(header->cardCount) * sizeof(BinaryCard);
+    std::size_t stringsAt = codeAt + header->codeBytes;
+    if (stringsAt + header->stringBytes != size) throw corrupt();
+    const char* strings = base + stringsAt;
+    if (header->stringBytes == 0 || strings[header->stringBytes - 1] != '\0') throw corrupt();
+
+    // Summons were written against ids that start right after the base set. If
+    // other databases were loaded first, this file's bytecode needs rebasing and
+    // cannot be used in place.
+    const auto* code = reinterpret_cast<const std::uint8_t*>(base + codeAt);
+    std::uint16_t shift = static_cast<std::uint16_t>(reg.defs.size() - NUM_CARDS);
+    std::unique_ptr<std::uint8_t[]> rebased;
+    if (shift) {
+        rebased = std::make_unique<std::uint8_t[]>(header->codeBytes);
+        std::copy(code, code + header->codeBytes, rebased.get());
+        code = rebased.get();
+    }
+
+    std::size_t first = reg.defs.size();
+    reg.byName.reserve(first + header->cardCount);
+    const auto* cards = reinterpret_cast<const BinaryCard*>(base + cardsAt);
+    for (std::size_t i = 0; i < header->cardCount; ++i) {
+        const BinaryCard& rec = cards[i];
+        if (rec.name >= header->stringBytes || rec.desc >= header->stringBytes
+            || std::size_t(rec.effectBegin) + rec.effectSize > header->codeBytes
+            || rec.type > static_cast<std::uint8_t>(CardType::Ritual)
+            || rec.trigger > static_cast<std::uint8_t>(TriggerType::None)) {
+            throw corrupt();
+        }
+        CardDef def{};
+        def.name = strings + rec.name;
+        def.desc = strings + rec.desc;
+        def.type = static_cast<CardType>(rec.type);
+        def.trigger = static_cast<TriggerType>(rec.trigger);
+        def.cost = rec.cost;
+        def.attack = rec.attack;
+        def.defense = rec.defense;
+        def.abilityCost = rec.abilityCost;
+        def.charges = rec.charges;
+        def.activationCost = rec.activationCost;
+        def.requiresTarget = rec.requiresTarget != 0;
+        def.effect.code = code + rec.effectBegin;
+        def.effect.size = rec.effectSize;
+        std::string problem = verifyEffect(def.effect);
+        if (!problem.empty()) throw corrupt();
+        if (shift) {
+            forEachSummon(def.effect, [shift](std::uint8_t* card) {
+                std::uint16_t id = static_cast<std::uint16_t>(card[0] | (card[1] << 8));
+                if (id >= NUM_CARDS) id += shift;
+                card[0] = id & 0xFF;
+                card[1] = id >> 8;
+            });
+        }
+        if (!addCard(reg, def)) {
+            throw std::runtime_error(filename + ": duplicate card name '" + def.name + "'");
+        }
+    }
+    if (rebased) reg.code.push_back(std::move(rebased));
+    validate(reg, first, filename);
+}
+
+} // namespace
+
+void CardDatabase::load(const std::string& filename) {
+    char magic[sizeof(BINARY_MAGIC)] = {};
+    {
+        std::ifstream probe(filename, std::ios::binary);
+        if (!probe) throw std::runtime_error("Could not open card database " + filename);
+        probe.read(magic, sizeof(magic));
+    }
+    if (std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0) {
+        loadBinary(registry(), filename);
+    } else {
+        loadText(registry(), filename);
+    }
+}
+
+void CardDatabase::compile(const std::string& filename) {
+    const Registry& reg = registry();
+    std::vector<BinaryCard> cards;
+    std::vector<std::uint8_t> code;
+    std::string strings;
+    auto addString = [&strings](const char* s) {
+        std::uint32_t at = static_cast<std::uint32_t>(strings.size());
+        strings.append(s);
+        strings.push_back('\0');
+        return at;
+    };
+    for (std::size_t i = NUM_CARDS; i < reg.defs.size(); ++i) {
+        const CardDef& def = reg.defs[i];
+        BinaryCard rec{};
+        rec.name = addString(def.name);
+        rec.desc = addString(def.desc);
+        rec.effectBegin = static_cast<std::uint32_t>(code.size());
+        rec.effectSize = def.effect.size;
+        rec.type = static_cast<std::uint8_t>(def.type);
+        rec.trigger = static_cast<std::uint8_t>(def.trigger);
+        rec.cost = static_cast<std::int16_t>(def.cost);
+        rec.attack = static_cast<std::int16_t>(def.attack);
+        rec.defense = static_cast<std::int16_t>(def.defense);
+        rec.abilityCost = static_cast<std::int16_t>(def.abilityCost);
+        rec.charges = static_cast<std::int16_t>(def.charges);
+        rec.activationCost = static_cast<std::int16_t>(def.activationCost);
+        rec.requiresTarget = def.requiresTarget;
+        code.insert(code.end(), def.effect.code, def.effect.code + def.effect.size);
+        cards.push_back(rec);
+    }
+    while (code.size() % 4) code.push_back(op(EffectOp::Halt));
+    if (strings.empty()) strings.push_back('\0');
+    // Keep the file size a multiple of 4 so every section stays aligned
+    while (strings.size() % 4) strings.push_back('\0');
+
+    BinaryHeader header{};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.version = BINARY_VERSION;
+    header.cardCount = static_cast<std::uint32_t>(cards.size());
+    header.codeBytes = static_cast<std::uint32_t>(code.size());
+    header.stringBytes = static_cast<std::uint32_t>(strings.size());
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::runtime_error("Could not write card database " + filename);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(cards.data()), cards.size() * sizeof(BinaryCard));
+    out.write(reinterpret_cast<const char*>(code.data()), code.size());
+    out.write(strings.data(), strings.size());
+    if (!out) throw std::runtime_error("Could not write card database " + filename);
+}
+
+const CardDef& CardDatabase::get(CardId id) {
+    const Registry& reg = registry();
+    std::size_t idx = static_cast<std::size_t>(id);
+    if (idx >= reg.defs.size()) throw std::runtime_error("Unknown card id: " + std::to_string(idx));
+    return reg.defs[idx];
+}
+
+CardId CardDatabase::find(std::string_view name) {
+    const Registry& reg = registry();
+    auto it = reg.byName.find(name);
+    return it == reg.byName.end() ? CardId::Invalid : it->second;
+}
+
+std::size_t CardDatabase::size() { return registry().defs.size(); }
@@ -0,0 +1,50 @@
+#ifndef CARDDB_H
+#define CARDDB_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include "cardtable.h"
+
+// Registry of every card definition known to the game: the compiled-in
+// CARD_TABLE followed by any cards loaded from a database file. Ids of loaded
+// cards continue after the base set, so CardId stays a plain array index.
+//
+// A database is either the text authoring format, one block per card:
+//
+//     # Lines starting with '#' are comments
+//     [Frost Imp]
+//     type = minion
+//     cost = 1
+//     attack = 1
+//     defense = 2
+//     trigger = enters
+//     desc = Whenever an opponent's minion enters play, deal 1 damage to it.
+//     effect = damage enemy-target 1
+//
+// Keys are type (minion, spell or ritual), cost, attack, defense, ability
+// (activated ability cost), trigger (enters, leaves, start or end), charges,
+// activation, target (yes or no, for spells), desc and any number of effect
+// lines built from 'damage <scope> <n>', 'buff <scope> <atk> <def>',
+// 'destroy <scope>', 'bounce <scope>', 'disenchant <scope>',
+// 'summon <n> <card name>', 'resurrect', 'charge <n>' and 'magic <n>'
+// (scopes: target, own-target, enemy-target, own, enemy, all, self). Effect
+// lines compile to effect bytecode (see effect.h). The other form is the
+// binary database written by compile(), which is memory-mapped and whose
+// bytecode is run in place.
+//
+// Loading happens once at startup; afterwards the registry is read-only.
+class CardDatabase {
+public:
+    // Loads a text or binary database, detected from the file contents
+    static void load(const std::string& filename);
+    // Writes every loaded (non-base) card to a binary database
+    static void compile(const std::string& filename);
+
+    static const CardDef& get(CardId id);
+    // Returns CardId::Invalid if no card has this name
+    static CardId find(std::string_view name);
+    static std::size_t size();
+};
+
+#endif
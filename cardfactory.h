@@ -3,14 +3,15 @@
 
 #include <string>
 #include <memory>
+#include "card.h"
 
-class Card;
 class Player;
 
-// A factory class to create card objects from their names
+// A factory class to create card objects from their names or ids
 class CardFactory {
 public:
     static std::shared_ptr<Card> createCard(const std::string& cardName, Player* owner);
+    static std::shared_ptr<Card> createCard(CardId id, Player* owner);
 };
 
 #endif
@@ -0,0 +1,163 @@
+#ifndef CARDTABLE_H
+#define CARDTABLE_H
+
+#include <cstddef>
+#include <string_view>
+#include "card.h"
+#include "effect.h"
+
+// Static definition of a card. For the base set every row is a compile-time
+// constant, so the card classes instantiated from CARD_TABLE look theirs up
+// and check its type at compile time. The stats and charges are only where a
+// card starts: in play they are ordinary runtime values.
+struct CardDef {
+    CardId id;
+    const char* name;
+    CardType type;
+    int cost;
+    int attack;          // Minions only
+    int defense;         // Minions only
+    int abilityCost;     // Minions with an activated ability only
+    TriggerType trigger; // Triggered minions and rituals
+    int charges;         // Rituals only
+    int activationCost;  // Rituals only
+    bool requiresTarget; // Spells only
+    const char* desc;    // Ability, trigger, spell or enchantment text
+    EffectProgram effect; // Spell, ability, trigger or ritual effect
+};
+
+// --- Row builders, one per card type ---
+constexpr CardDef minionDef(CardId id, const char* name, int cost, int attack, int defense,
+                            int abilityCost = 0, TriggerType trigger = TriggerType::None,
+                            const char* desc = "", EffectProgram effect = {}) {
+    return {id, name, CardType::Minion, cost, attack, defense, abilityCost, trigger, 0, 0, false, desc, effect};
+}
+
+constexpr CardDef spellDef(CardId id, const char* name, int cost, bool requiresTarget, const char* desc,
+                           EffectProgram effect) {
+    return {id, name, CardType::Spell, cost, 0, 0, 0, TriggerType::None, 0, 0, requiresTarget, desc, effect};
+}
+
+constexpr CardDef enchantmentDef(CardId id, const char* name, int cost, const char* desc) {
+    return {id, name, CardType::Enchantment, cost, 0, 0, 0, TriggerType::None, 0, 0, true, desc, {}};
+}
+
+constexpr CardDef ritualDef(CardId id, const char* name, int cost, int charges, int activationCost,
+                            TriggerType trigger, const char* desc, EffectProgram effect) {
+    return {id, name, CardType::Ritual, cost, 0, 0, 0, trigger, charges, activationCost, false, desc, effect};
+}
+
+// --- Effect bytecode of the base set (instruction set in effect.h) ---
+namespace effects {
+constexpr std::uint8_t AIR_ELEMENTAL_LO = static_cast<std::uint16_t>(CardId::AirElemental) & 0xFF;
+constexpr std::uint8_t AIR_ELEMENTAL_HI = static_cast<std::uint16_t>(CardId::AirElemental) >> 8;
+
+constexpr std::uint8_t BONE_GOLEM[] = {
+    op(EffectOp::Select), scope(EffectScope::Self), op(EffectOp::Buff), 1, 1, op(EffectOp::Halt)};
+constexpr std::uint8_t FIRE_ELEMENTAL[] = {
+    op(EffectOp::Select), scope(EffectScope::EnemyTarget), op(EffectOp::Damage), 1, op(EffectOp::Halt)};
+constexpr std::uint8_t POTION_SELLER[] = {
+    op(EffectOp::Select), scope(EffectScope::Own), op(EffectOp::Buff), 0, 1, op(EffectOp::Halt)};
+constexpr std::uint8_t NOVICE_PYROMANCER[] = {
+    op(EffectOp::Select), scope(EffectScope::Target), op(EffectOp::Damage), 1, op(EffectOp::Halt)};
+constexpr std::uint8_t APPRENTICE_SUMMONER[] = {
+    op(EffectOp::Summon), AIR_ELEMENTAL_LO, AIR_ELEMENTAL_HI, 1, op(EffectOp::Halt)};
+constexpr std::uint8_t MASTER_SUMMONER[] = {
+    op(EffectOp::Summon), AIR_ELEMENTAL_LO, AIR_ELEMENTAL_HI, 3, op(EffectOp::Halt)};
+
+// Ritual targets branch over the minion case
+constexpr std::uint8_t BANISH[] = {
+    op(EffectOp::BranchIfRitual), 4,
+    op(EffectOp::Select), scope(EffectScope::Target), op(EffectOp::Destroy), op(EffectOp::Halt),
+    op(EffectOp::DestroyRitual), op(EffectOp::Halt)};
+constexpr std::uint8_t UNSUMMON[] = {
+    op(EffectOp::Select), scope(EffectScope::Target), op(EffectOp::Bounce), op(EffectOp::Halt)};
+constexpr std::uint8_t RECHARGE[] = {op(EffectOp::GainCharges), 3, op(EffectOp::Halt)};
+constexpr std::uint8_t DISENCHANT[] = {
+    op(EffectOp::Select), scope(EffectScope::Target), op(EffectOp::Disenchant), op(EffectOp::Halt)};
+constexpr std::uint8_t RAISE_DEAD[] = {op(EffectOp::Resurrect), op(EffectOp::Halt)};
+constexpr std::uint8_t BLIZZARD[] = {
+    op(EffectOp::Select), scope(EffectScope::All), op(EffectOp::Damage), 2, op(EffectOp::Halt)};
+
+constexpr std::uint8_t DARK_RITUAL[] = {op(EffectOp::GainMagic), 1, op(EffectOp::Halt)};
+constexpr std::uint8_t AURA_OF_POWER[] = {
+    op(EffectOp::Select), scope(EffectScope::OwnTarget), op(EffectOp::Buff), 1, 1, op(EffectOp::Halt)};
+constexpr std::uint8_t STANDSTILL[] = {
+    op(EffectOp::Select), scope(EffectScope::Target), op(EffectOp::Destroy), op(EffectOp::Halt)};
+} // namespace effects
+
+// The base card set, indexed by CardId
+constexpr CardDef CARD_TABLE[] = {
+    // Minions
+    minionDef(CardId::AirElemental, "Air Elemental", 0, 1, 1),
+    minionDef(CardId::EarthElemental, "Earth Elemental", 3, 4, 4),
+    minionDef(CardId::BoneGolem, "Bone Golem", 2, 1, 3, 0, TriggerType::MinionLeaves,
+              "Gain +1/+1 whenever a minion leaves play.", program(effects::BONE_GOLEM)),
+    minionDef(CardId::FireElemental, "Fire Elemental", 2, 2, 2, 0, TriggerType::MinionEnters,
+              "Whenever an opponent's minion enters play, deal 1 damage to it.", program(effects::FIRE_ELEMENTAL)),
+    minionDef(CardId::PotionSeller, "Potion Seller", 2, 1, 3, 0, TriggerType::EndOfTurn,
+              "At the end of your turn, all your minions gain +0/+1.", program(effects::POTION_SELLER)),
+    minionDef(CardId::NovicePyromancer, "Novice Pyromancer", 1, 0, 1, 1, TriggerType::None,
+              "Deal 1 damage to target minion", program(effects::NOVICE_PYROMANCER)),
+    minionDef(CardId::ApprenticeSummoner, "Apprentice Summoner", 1, 1, 1, 1, TriggerType::None,
+              "Summon a 1/1 air elemental", program(effects::APPRENTICE_SUMMONER)),
+    minionDef(CardId::MasterSummoner, "Master Summoner", 3, 2, 3, 2, TriggerType::None,
+              "Summon up to three 1/1 air elementals", program(effects::MASTER_SUMMONER)),
+
+    // Spells
+    spellDef(CardId::Banish, "Banish", 2, true, "Destroy target minion or ritual",
+             program(effects::BANISH)),
+    spellDef(CardId::Unsummon, "Unsummon", 1, true, "Return target minion to its owner's hand",
+             program(effects::UNSUMMON)),
+    spellDef(CardId::Recharge, "Recharge", 1, false, "Your ritual gains 3 charges", program(effects::RECHARGE)),
+    spellDef(CardId::Disenchant, "Disenchant", 1, true, "Destroy the top enchantment on target minion",
+             program(effects::DISENCHANT)),
+    spellDef(CardId::RaiseDead, "Raise Dead", 1, false,
+             "Resurrect the top minion in your graveyard and set its defense to 1", program(effects::RAISE_DEAD)),
+    spellDef(CardId::Blizzard, "Blizzard", 3, false, "Deal 2 damage to all minions", program(effects::BLIZZARD)),
+
+    // Enchantments
+    enchantmentDef(CardId::GiantStrength, "Giant Strength", 1, ""),
+    enchantmentDef(CardId::Enrage, "Enrage", 2, ""),
+    enchantmentDef(CardId::Haste, "Haste", 1, "Enchanted minion gains +1 action each turn"),
+    enchantmentDef(CardId::MagicFatigue, "Magic Fatigue", 0, "Enchanted minion's activated ability costs 2 more"),
+    enchantmentDef(CardId::Silence, "Silence", 1, "Enchanted minion cannot use abilities"),
+
+    // Rituals
+    ritualDef(CardId::DarkRitual, "Dark Ritual", 0, 5, 1, TriggerType::StartOfTurn,
+              "At the start of your turn, gain 1 magic", program(effects::DARK_RITUAL)),
+    ritualDef(CardId::AuraOfPower, "Aura of Power", 1, 4, 1, TriggerType::MinionEnters,
+              "Whenever a minion enters play under your control, it gains +1/+1", program(effects::AURA_OF_POWER)),
+    ritualDef(CardId::Standstill, "Standstill", 3, 4, 2, TriggerType::MinionEnters,
+              "Whenever a minion enters play, destroy it", program(effects::STANDSTILL)),
+};
+
+constexpr std::size_t NUM_CARDS = sizeof(CARD_TABLE) / sizeof(CARD_TABLE[0]);
+
+// Every row must sit at the index of its own id, so lookups are plain array indexing
+constexpr bool cardTableIsIndexed() {
+    for (std::size_t i = 0; i < NUM_CARDS; ++i) {
+        if (static_cast<std::size_t>(CARD_TABLE[i].id) != i) return false;
+    }
+    return true;
+}
+static_assert(cardTableIsIndexed(), "CARD_TABLE rows must be ordered by CardId");
+static_assert(NUM_CARDS == static_cast<std::size_t>(CardId::Standstill) + 1, "CARD_TABLE is missing a card");
+
+constexpr const CardDef& cardDef(CardId id) { return CARD_TABLE[static_cast<std::size_t>(id)]; }
+
+// True if cards built from this definition carry an Ability object
+constexpr bool hasAbility(const CardDef& def) {
+    return def.abilityCost > 0 || def.trigger != TriggerType::None;
+}
+constexpr bool hasAbility(CardId id) { return hasAbility(cardDef(id)); }
+
+// Maps a card name to its id, or CardId::Invalid if the name is not in the table
+constexpr CardId findCardId(std::string_view name) {
+    for (std::size_t i = 0; i < NUM_CARDS; ++i) {
+        if (name == CARD_TABLE[i].name) return CARD_TABLE[i].id;
+    }
+    return CardId::Invalid;
+}
+
+#endif
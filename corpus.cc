@@ -0,0 +1,137 @@
+#include "corpus.h"
+#include "game.h"
+#include "parallel.h"
+#include "savefile.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Script {
+    fs::path path;
+    std::string deck1_file;
+    std::string deck2_file;
+    std::uint64_t digest = 0;
+    bool has_digest = false;
+
+    // Filled in by the run
+    std::uint64_t result = 0;
+    double seconds = 0;
+    std::string error;
+};
+
+std::string hex(std::uint64_t value) {
+    std::ostringstream s;
+    s << std::hex << std::setw(16) << std::setfill('0') << value;
+    return s.str();
+}
+
+std::string sibling(const fs::path& script, const char* extension, const std::string& fallback) {
+    fs::path p = script;
+    p.replace_extension(extension);
+    return fs::exists(p) ? p.string() : fallback;
+}
+
+std::vector<Script> findScripts(const CorpusOptions& options) {
+    if (!fs::is_directory(options.dir)) throw std::runtime_error("Not a directory: " + options.dir);
+    std::vector<Script> scripts;
+    for (const auto& entry : fs::directory_iterator(options.dir)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".txt") continue;
+        Script s;
+        s.path = entry.path();
+        s.deck1_file = sibling(s.path, ".deck1", options.deck1_file);
+        s.deck2_file = sibling(s.path, ".deck2", options.deck2_file);
+        fs::path digest = s.path;
+        digest.replace_extension(".digest");
+        std::ifstream in(digest);
+        std::string text;
+        if (in >> text) {
+            s.digest = std::stoull(text, nullptr, 16);
+            s.has_digest = true;
+        }
+        scripts.push_back(std::move(s));
+    }
+    std::sort(scripts.begin(), scripts.end(), [](const Script& a, const Script& b) { return a.path < b.path; });
+    return scripts;
+}
+
+// Plays a script the way -init would, with nothing shown
+void play(Script& script, const CorpusOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+        std::ifstream in(script.path);
+        if (!in) throw std::runtime_error("Could not open " + script.path.string());
+        std::ostream discard(nullptr);
+        Game game(script.deck1_file, script.deck2_file, "", options.testing, false, discard, discard);
+        game.seed(options.seed);
+        game.start();
+        std::string line;
+        while (!game.isOver() && std::getline(in, line)) game.resume(line);
+        script.result = stateDigest(game);
+    } catch (const std::exception& e) {
+        script.error = e.what();
+    }
+    script.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+std::uint64_t stateDigest(Game& game) {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    // A script that never named both players leaves nothing to save
+    if (game.getPlayer(1)) {
+        for (unsigned char c : encodeSave(game.getSaveData())) {
+            h ^= c;
+            h *= 0x100000001b3ull;
+        }
+    }
+    h ^= static_cast<std::uint64_t>(game.getWinner() + 3 * game.isOver()) * 0x9e3779b97f4a7c15ull;
+    return h;
+}
+
+int runCorpus(const CorpusOptions& options, std::ostream& out) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Script> scripts = findScripts(options);
+    unsigned threads = threadCount(options.threads, scripts.size());
+    parallelFor(scripts.size(), threads, [&](unsigned, std::size_t i) { play(scripts[i], options); });
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int passed = 0, failed = 0, missing = 0;
+    double total = 0;
+    for (const Script& s : scripts) {
+        total += s.seconds;
+        out << std::left << std::setw(24) << s.path.filename().string() << std::right;
+        if (!s.error.empty()) {
+            out << "  error  " << s.error;
+            ++failed;
+        } else if (options.record) {
+            fs::path digest = s.path;
+            digest.replace_extension(".digest");
+            std::ofstream(digest) << hex(s.result) << '\n';
+            out << "  saved  " << hex(s.result);
+            ++missing;
+        } else if (!s.has_digest) {
+            out << "  new    " << hex(s.result);
+            ++missing;
+        } else if (s.digest == s.result) {
+            out << "  ok     ";
+            ++passed;
+        } else {
+            out << "  FAIL   expected " << hex(s.digest) << ", got " << hex(s.result);
+            ++failed;
+        }
+        out << "  " << std::fixed << std::setprecision(2) << s.seconds * 1000 << "ms" << std::endl;
+    }
+    out << scripts.size() << " scripts in " << std::setprecision(3) << wall << "s on " << threads << " thread"
+        << (threads == 1 ? "" : "s") << " (" << total << "s of games): " << passed << " ok, " << failed
+        << " failed, " << missing << (options.record ? " recorded" : " without a digest") << std::endl;
+    out.unsetf(std::ios::floatfield);
+    return failed;
+}
@@ -0,0 +1,39 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+class Game;
+
+// --- Regression corpus ---
+// Replays a directory of recorded -init scripts inside one process and checks
+// each game ends where it should. For a script NAME.txt the directory may
+// also hold:
+//
+//     NAME.deck1, NAME.deck2   decks for the script; otherwise the defaults
+//     NAME.digest              the expected digest of the final state, in hex
+//
+// Games run headless, so nothing is rendered, and scripts are shared out
+// between threads. Each game is seeded, so scripts that shuffle replay the
+// same way every run.
+struct CorpusOptions {
+    std::string dir;
+    std::string deck1_file = "default.deck";
+    std::string deck2_file = "default.deck";
+    bool testing = false;
+    bool record = false; // Write each script's digest instead of checking it
+    unsigned threads = 0; // 0 is one per core
+    unsigned seed = 1;
+};
+
+// Prints a line per script, in name order, then the totals. Returns the
+// number of scripts whose digest didn't match.
+int runCorpus(const CorpusOptions& options, std::ostream& out);
+
+// Hash of everything a save holds (names, random number generator and
+// position), the winner and whether the game is over
+std::uint64_t stateDigest(Game& game);
+
+#endif
@@ -0,0 +1,251 @@
+#include "decksearch.h"
+#include "bot.h"
+#include "carddb.h"
+#include "game.h"
+#include "parallel.h"
+#include "rng.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+using Counts = std::vector<std::uint8_t>; // Copies of each card, by id
+
+std::vector<CardId> cardsOf(const Counts& counts) {
+    std::vector<CardId> deck;
+    for (std::size_t id = 0; id < counts.size(); ++id) deck.insert(deck.end(), counts[id], static_cast<CardId>(id));
+    return deck;
+}
+
+std::string keyOf(const Counts& counts) { return std::string(counts.begin(), counts.end()); }
+
+// Random decks and their offspring, always of the right size
+class Breeder {
+    const DeckSearchOptions& options;
+    Rng rng;
+
+    int below(int n) { return static_cast<int>(rng() % static_cast<std::uint64_t>(n)); }
+
+    void removeCard(Counts& counts, int total) {
+        int k = below(total);
+        for (auto& c : counts) {
+            if (k < c) {
+                --c;
+                return;
+            }
+            k -= c;
+        }
+    }
+
+    void addCard(Counts& counts) {
+        int open = 0;
+        for (auto c : counts) open += c < options.max_copies;
+        int k = below(open);
+        for (auto& c : counts) {
+            if (c < options.max_copies && k-- == 0) {
+                ++c;
+                return;
+            }
+        }
+    }
+
+public:
+    Breeder(const DeckSearchOptions& options) : options(options), rng(options.seed) {}
+
+    // Takes cards out or puts them in at random until the deck is the right size
+    void repair(Counts& counts) {
+        int total = 0;
+        for (auto& c : counts) {
+            c = std::min<int>(c, options.max_copies);
+            total += c;
+        }
+        for (; total > options.deck_size; --total) removeCard(counts, total);
+        for (; total < options.deck_size; ++total) addCard(counts);
+    }
+
+    Counts random(std::size_t cards) {
+        Counts counts(cards, 0);
+        repair(counts);
+        return counts;
+    }
+
+    // Each card's count from one parent or the other
+    Counts cross(const Counts& a, const Counts& b) {
+        Counts child(a.size());
+        for (std::size_t id = 0; id < a.size(); ++id) child[id] = rng() & 1 ? a[id] : b[id];
+        repair(child);
+        return child;
+    }
+
+    // Swaps one or two cards for others
+    void mutate(Counts& counts) {
+        for (int swaps = 1 + below(2); swaps > 0; --swaps) {
+            removeCard(counts, options.deck_size);
+            addCard(counts);
+        }
+    }
+
+    // The best of three at random, from a population sorted best first
+    std::size_t select(std::size_t size) {
+        std::size_t pick = size;
+        for (int k = 0; k < 3; ++k) pick = std::min(pick, static_cast<std::size_t>(below(static_cast<int>(size))));
+        return pick;
+    }
+};
+
+// A game and bot for one thread, kept for the whole search
+struct Simulator {
+    ScratchGame scratch;
+    GreedyBot bot;
+
+    // The deck's score over its games against one opponent, alternating seats
+    double play(const std::vector<CardId>& deck, const std::vector<CardId>& opponent,
+                const DeckSearchOptions& options) {
+        Game& game = scratch.get(false);
+        double score = 0;
+        for (int g = 0; g < options.games; ++g) {
+            bool swapped = g % 2;
+            game.seed(options.seed + g / 2);
+            game.deal(swapped ? opponent : deck, swapped ? deck : opponent);
+            int winner = playOut(game, bot, options.max_turns);
+            score += !winner ? 0.5 : (winner == 1) != swapped ? 1 : 0;
+        }
+        return score / options.games;
+    }
+};
+
+} // namespace
+
+DeckSearchResult runDeckSearch(const DeckSearchOptions& options, std::ostream& out) {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t cards = CardDatabase::size();
+    if (options.gauntlet.empty()) throw std::runtime_error("A deck search needs at least one gauntlet deck");
+    if (options.deck_size < 1 || static_cast<std::size_t>(options.deck_size) > cards * options.max_copies) {
+        throw std::runtime_error("No deck of " + std::to_string(options.deck_size) + " cards can be built");
+    }
+    if (options.population < 2 || options.games < 1) {
+        throw std::runtime_error("A deck search needs a population of two and a game per opponent");
+    }
+
+    std::vector<std::vector<CardId>> gauntlet;
+    for (const auto& deck : options.gauntlet) gauntlet.push_back(Player::readDeck(deck));
+
+    // The first generation: the gauntlet decks, cut or filled to size, then
+    // random decks
+    Breeder breeder(options);
+    std::vector<Counts> population;
+    for (const auto& deck : gauntlet) {
+        if (population.size() == static_cast<std::size_t>(options.population)) break;
+        Counts counts(cards, 0);
+        for (CardId id : deck) ++counts[static_cast<std::size_t>(id)];
+        breeder.repair(counts);
+        population.push_back(counts);
+    }
+    while (population.size() < static_cast<std::size_t>(options.population)) {
+        population.push_back(breeder.random(cards));
+    }
+
+    unsigned threads = threadCount(options.threads, options.population * options.gauntlet.size());
+    std::vector<Simulator> simulators(threads);
+
+    std::unordered_map<std::string, double> fitness; // Every deck played, by its counts
+    DeckSearchResult result;
+    std::size_t elite = std::max(1, options.population / 6);
+    for (int generation = 1;; ++generation) {
+        auto generation_start = std::chrono::steady_clock::now();
+
+        // Play the decks not seen before, a job per deck and opponent
+        std::vector<const Counts*> fresh;
+        std::vector<std::vector<CardId>> decks;
+        for (const Counts& counts : population) {
+            if (fitness.count(keyOf(counts))) continue;
+            fitness[keyOf(counts)] = 0;
+            fresh.push_back(&counts);
+            decks.push_back(cardsOf(counts));
+        }
+        int seen = static_cast<int>(population.size() - fresh.size());
+        std::vector<double> scores(fresh.size() * gauntlet.size());
+        parallelFor(scores.size(), threads, [&](unsigned worker, std::size_t job) {
+            scores[job] = simulators[worker].play(decks[job / gauntlet.size()], gauntlet[job % gauntlet.size()],
+                                                   options);
+        });
+        for (std::size_t i = 0; i < fresh.size(); ++i) {
+            double total = 0;
+            for (std::size_t o = 0; o < gauntlet.size(); ++o) total += scores[i * gauntlet.size() + o];
+            fitness[keyOf(*fresh[i])] = total / gauntlet.size();
+        }
+        result.evaluated += static_cast<int>(fresh.size());
+        result.cached += seen;
+
+        // Best first
+        std::vector<double> values;
+        for (const Counts& counts : population) values.push_back(fitness[keyOf(counts)]);
+        std::vector<std::size_t> order(population.size());
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::stable_sort(order.begin(), order.end(),
+                         [&](std::size_t a, std::size_t b) { return values[a] > values[b]; });
+        std::vector<Counts> sorted;
+        double mean = 0;
+        for (std::size_t i : order) {
+            sorted.push_back(population[i]);
+            mean += values[i] / population.size();
+        }
+        population = std::move(sorted);
+        if (values[order[0]] > result.fitness || result.best.empty()) {
+            result.fitness = values[order[0]];
+            result.best = cardsOf(population[0]);
+        }
+
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - generation_start).count();
+        out << "generation " << std::setw(3) << generation << ": best " << std::fixed << std::setprecision(1)
+            << std::setw(5) << values[order[0]] * 100 << "%, mean " << std::setw(5) << mean * 100 << "%, "
+            << fresh.size() << " new, " << seen << " seen before, " << std::setprecision(2) << seconds << 's'
+            << std::endl;
+        out.unsetf(std::ios::floatfield);
+        if (generation == options.generations) break;
+
+        // The elite carry over, and the rest are bred from the whole
+        // population, bred again (up to a point) if already in the next one
+        std::vector<Counts> next_population(population.begin(), population.begin() + elite);
+        std::unordered_set<std::string> taken;
+        for (const Counts& counts : next_population) taken.insert(keyOf(counts));
+        while (next_population.size() < population.size()) {
+            Counts child;
+            for (int attempt = 0; attempt < 10; ++attempt) {
+                child = breeder.cross(population[breeder.select(population.size())],
+                                      population[breeder.select(population.size())]);
+                breeder.mutate(child);
+                if (!taken.count(keyOf(child))) break;
+            }
+            taken.insert(keyOf(child));
+            next_population.push_back(std::move(child));
+        }
+        population = std::move(next_population);
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    out << "Best deck, " << std::fixed << std::setprecision(1) << result.fitness * 100 << "% against the gauntlet:\n";
+    Counts best(cards, 0);
+    for (CardId id : result.best) ++best[static_cast<std::size_t>(id)];
+    for (std::size_t id = 0; id < cards; ++id) {
+        if (!best[id]) continue;
+        out << std::setw(4) << int(best[id]) << ' ' << CardDatabase::get(static_cast<CardId>(id)).name << '\n';
+    }
+    out << result.evaluated << " decks played (" << result.evaluated * gauntlet.size() * options.games
+        << " games) and " << result.cached << " seen before, in " << std::setprecision(3) << wall << "s on "
+        << threads << " thread" << (threads == 1 ? "" : "s") << std::endl;
+    out.unsetf(std::ios::floatfield);
+    return result;
+}
+
+void writeDeck(const std::string& filename, const std::vector<CardId>& deck) {
+    std::ofstream file(filename);
+    if (!file) throw std::runtime_error("Could not write deck file " + filename);
+    for (CardId id : deck) file << CardDatabase::get(id).name << '\n';
+}
@@ -0,0 +1,50 @@
+#ifndef DECKSEARCH_H
+#define DECKSEARCH_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class CardId : std::uint16_t;
+
+// --- Deck search ---
+// Evolves decks against a gauntlet of reference decks with a genetic
+// algorithm. A deck is a count per card in the card database, from 0 to
+// max_copies, adding up to deck_size. Each generation keeps its best decks
+// and breeds the rest from decks picked by tournament selection, crossing
+// their counts card by card and then swapping a card or two at random.
+//
+// A deck's fitness is its score (wins plus half the draws, per game) over
+// games against every gauntlet deck with the greedy bot (see bot.h) on both
+// sides, alternating seats. Every deck plays the same seeds, so fitnesses
+// compare fairly and a deck seen before keeps the fitness it got the first
+// time instead of being played again. Games are shared out between threads,
+// each dealing every game into one Game of its own.
+struct DeckSearchOptions {
+    std::vector<std::string> gauntlet; // Deck files to play against
+    int deck_size = 20;
+    int max_copies = 3;
+    int population = 24;
+    int generations = 20;
+    int games = 20;      // Per gauntlet deck, for each new deck
+    int max_turns = 200; // A game still going after this many is a draw
+    unsigned threads = 0; // 0 is one per core
+    unsigned seed = 1;
+};
+
+struct DeckSearchResult {
+    std::vector<CardId> best; // The fittest deck found, in card database order
+    double fitness = 0;
+    int evaluated = 0; // Decks played
+    int cached = 0;    // Decks bred again and not replayed
+};
+
+// Prints a line per generation, then the best deck. The gauntlet decks also
+// seed the first generation. Throws if one can't be read.
+DeckSearchResult runDeckSearch(const DeckSearchOptions& options, std::ostream& out);
+
+// Writes a deck in the format Player::loadDeck reads, a card name a line
+void writeDeck(const std::string& filename, const std::vector<CardId>& deck);
+
+#endif
@@ -0,0 +1,256 @@
+#include "effect.h"
+#include "player.h"
+#include "game.h"
+#include "minion.h"
+#include "ritual.h"
+#include "cardfactory.h"
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// Ritual targets use this card index (see Game::process_command)
+constexpr int RITUAL_IDX = 5;
+
+// The minions an instruction acts on. A board has at most ten.
+struct Selection {
+    Player* owner[10];
+    int idx[10];
+    int count = 0;
+
+    void add(Player* p, int i) {
+        owner[count] = p;
+        idx[count] = i;
+        ++count;
+    }
+};
+
+Player* opponentOf(Player* self) {
+    return self->getGame()->getPlayer(self->getPlayerId() == 1 ? 2 : 1);
+}
+
+// Slots are added from the right so removing one never shifts a later pick
+void selectBoard(Selection& sel, Player* owner) {
+    const auto& minions = owner->getMinions();
+    for (int i = 4; i >= 0; --i) {
+        if (minions[i]) sel.add(owner, i);
+    }
+}
+
+void selectTarget(Selection& sel, const EffectContext& ctx, EffectScope s) {
+    Player* t = ctx.target_player;
+    int i = ctx.target_card_idx;
+    if (!t || i < 0 || i > 4) {
+        if (ctx.lenient) return;
+        throw std::runtime_error("Invalid target.");
+    }
+    if (!t->getMinions()[i]) {
+        if (ctx.lenient) return;
+        throw std::runtime_error("Target minion does not exist.");
+    }
+    if (s == EffectScope::OwnTarget && t != ctx.self) return;
+    if (s == EffectScope::EnemyTarget && t == ctx.self) return;
+    sel.add(t, i);
+}
+
+void select(Selection& sel, const EffectContext& ctx, EffectScope s) {
+    sel.count = 0;
+    switch (s) {
+        case EffectScope::Own:
+            selectBoard(sel, ctx.self);
+            break;
+        case EffectScope::Enemy:
+            selectBoard(sel, opponentOf(ctx.self));
+            break;
+        case EffectScope::All:
+            selectBoard(sel, ctx.self);
+            selectBoard(sel, opponentOf(ctx.self));
+            break;
+        case EffectScope::Self:
+            if (ctx.source_idx >= 0 && ctx.self->getMinions()[ctx.source_idx]) sel.add(ctx.self, ctx.source_idx);
+            break;
+        default:
+            selectTarget(sel, ctx, s);
+            break;
+    }
+}
+
+std::int8_t i8(const std::uint8_t* p) { return static_cast<std::int8_t>(*p); }
+std::uint16_t u16(const std::uint8_t* p) { return static_cast<std::uint16_t>(p[0] | (p[1] << 8)); }
+
+const char* const OP_NAMES[] = {
+    "halt", "select", "damage", "buff", "destroy", "bounce", "disenchant", "summon",
+    "resurrect", "charge", "magic", "destroy-ritual", "branch-if-ritual",
+};
+const char* const SCOPE_NAMES[] = {
+    "target", "own-target", "enemy-target", "own", "enemy", "all", "self",
+};
+static_assert(sizeof(OP_NAMES) / sizeof(OP_NAMES[0]) == static_cast<std::size_t>(EffectOp::Count), "Name every opcode");
+static_assert(sizeof(SCOPE_NAMES) / sizeof(SCOPE_NAMES[0]) == static_cast<std::size_t>(EffectScope::Count), "Name every scope");
+
+} // namespace
+
+// The dispatch loop. Programs are verified when loaded and always end in Halt,
+// so the loop needs no bounds checks.
+void runEffect(EffectProgram program, const EffectContext& ctx) {
+    if (program.empty()) return;
+    const std::uint8_t* pc = program.code;
+    Selection sel;
+    for (;;) {
+        EffectOp o = static_cast<EffectOp>(*pc++);
+        switch (o) {
+            case EffectOp::Halt:
+                return;
+            case EffectOp::Select:
+                select(sel, ctx, static_cast<EffectScope>(*pc));
+                break;
+            case EffectOp::Damage:
+                for (int k = 0; k < sel.count; ++k) {
+                    auto& m = sel.owner[k]->getMinions()[sel.idx[k]];
+                    if (m) m->takeDamage(i8(pc));
+                }
+                break;
+            case EffectOp::Buff:
+                for (int k = 0; k < sel.count; ++k) {
+                    auto& m = sel.owner[k]->getMinions()[sel.idx[k]];
+                    if (m) m->buff(i8(pc), i8(pc + 1));
+                }
+                break;
+            case EffectOp::Destroy:
+                for (int k = 0; k < sel.count; ++k) {
+                    if (sel.owner[k]->getMinions()[sel.idx[k]]) sel.owner[k]->removeMinion(sel.idx[k], true);
+                }
+                sel.count = 0;
+                break;
+            case EffectOp::Bounce:
+                for (int k = 0; k < sel.count; ++k) {
+                    auto minion = sel.owner[k]->getMinions()[sel.idx[k]];
+                    if (!minion) continue;
+                    minion->stripEnchantments();
+                    sel.owner[k]->getHand().push_back(minion);
+                    sel.owner[k]->removeMinion(sel.idx[k], false);
+                }
+                sel.count = 0;
+                break;
+            case EffectOp::Disenchant:
+                for (int k = 0; k < sel.count; ++k) {
+                    auto& m = sel.owner[k]->getMinions()[sel.idx[k]];
+                    if (m) m->stripTopEnchantment();
+                }
+                break;
+            case EffectOp::Summon: {
+                CardId card = static_cast<CardId>(u16(pc));
+                for (int k = 0; k < pc[2]; ++k) {
+                    try {
+                        ctx.self->addMinion(std::static_pointer_cast<Minion>(CardFactory::createCard(card, ctx.self)));
+                    } catch (const std::runtime_error& e) {
+                        ctx.self->getGame()->getOutput().detail() << "Board is full, stopping summoning.\n";
+                        break;
+                    }
+                }
+                break;
+            }
+            case EffectOp::Resurrect:
+                if (ctx.lenient && ctx.self->getGraveyard().empty()) break;
+                ctx.self->resurrect();
+                break;
+            case EffectOp::GainCharges:
+                if (!ctx.self->getRitual()) {
+                    if (ctx.lenient) break;
+                    throw std::runtime_error("You have no ritual to recharge.");
+                }
+                ctx.self->getRitual()->gainCharges(i8(pc));
+                break;
+            case EffectOp::GainMagic:
+                ctx.self->gainMagic(i8(pc));
+                break;
+            case EffectOp::DestroyRitual:
+                if (ctx.target_player) ctx.target_player->removeRitual();
+                break;
+            case EffectOp::BranchIfRitual:
+                if (ctx.target_card_idx == RITUAL_IDX) pc += *pc;
+                break;
+            case EffectOp::Count:
+                return;
+        }
+        pc += operandBytes(o);
+    }
+}
+
+std::string verifyEffect(EffectProgram program) {
+    if (program.empty()) return "";
+    // Instruction starts, so branch targets can be checked after the walk
+    std::string starts(program.size + 1, '\0');
+    std::size_t pc = 0;
+    std::size_t last = 0;
+    while (pc < program.size) {
+        starts[pc] = 1;
+        last = pc;
+        std::uint8_t raw = program.code[pc];
+        if (raw >= op(EffectOp::Count)) return "unknown opcode at " + std::to_string(pc);
+        EffectOp o = static_cast<EffectOp>(raw);
+        if (pc + 1 + operandBytes(o) > program.size) return "truncated instruction at " + std::to_string(pc);
+        if (o == EffectOp::Select && program.code[pc + 1] >= scope(EffectScope::Count)) {
+            return "unknown scope at " + std::to_string(pc);
+        }
+        pc += 1 + operandBytes(o);
+    }
+    if (program.code[last] != op(EffectOp::Halt)) return "program does not end in halt";
+    starts[program.size] = 1;
+    for (pc = 0; pc < program.size; pc += 1 + operandBytes(static_cast<EffectOp>(program.code[pc]))) {
+        if (program.code[pc] != op(EffectOp::BranchIfRitual)) continue;
+        std::size_t target = pc + 2 + program.code[pc + 1];
+        if (target >= program.size || !starts[target]) return "bad branch at " + std::to_string(pc);
+    }
+    return "";
+}
+
+std::string disassembleEffect(EffectProgram program) {
+    std::ostringstream out;
+    for (std::size_t pc = 0; pc < program.size;) {
+        EffectOp o = static_cast<EffectOp>(program.code[pc]);
+        if (pc) out << "; ";
+        out << OP_NAMES[program.code[pc]];
+        const std::uint8_t* arg = program.code + pc + 1;
+        switch (o) {
+            case EffectOp::Select: out << ' ' << SCOPE_NAMES[*arg]; break;
+            case EffectOp::Damage: case EffectOp::GainCharges: case EffectOp::GainMagic:
+                out << ' ' << int(i8(arg));
+                break;
+            case EffectOp::Buff: out << ' ' << int(i8(arg)) << ' ' << int(i8(arg + 1)); break;
+            case EffectOp::Summon: out << ' ' << int(arg[2]) << " #" << u16(arg); break;
+            case EffectOp::BranchIfRitual: out << " +" << int(*arg); break;
+            default: break;
+        }
+        pc += 1 + operandBytes(o);
+    }
+    return out.str();
+}
+
+std::uint64_t hashEffect(EffectProgram program) {
+    // FNV-1a
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t i = 0; i < program.size; ++i) {
+        h ^= program.code[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+EffectTargets effectTargets(EffectProgram program) {
+    EffectTargets targets;
+    for (std::size_t pc = 0; pc < program.size;) {
+        EffectOp o = static_cast<EffectOp>(program.code[pc]);
+        if (o == EffectOp::Select) {
+            auto s = static_cast<EffectScope>(program.code[pc + 1]);
+            if (s == EffectScope::Target || s == EffectScope::OwnTarget || s == EffectScope::EnemyTarget) {
+                targets.minion = true;
+            }
+        } else if (o == EffectOp::BranchIfRitual || o == EffectOp::DestroyRitual) {
+            targets.ritual = true;
+        }
+        pc += 1 + operandBytes(o);
+    }
+    return targets;
+}
@@ -0,0 +1,104 @@
+#ifndef EFFECT_H
+#define EFFECT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+class Player;
+
+// Instruction set of the effect bytecode that every spell, activated ability,
+// trigger and ritual compiles to. Operands follow the opcode byte:
+enum class EffectOp : std::uint8_t {
+    Halt,           // Ends the program; every program finishes with one
+    Select,         // scope:u8 - replaces the selection with the minions in scope
+    Damage,         // n:i8 - each selected minion takes n damage
+    Buff,           // atk:i8 def:i8 - each selected minion gains +atk/+def
+    Destroy,        // Moves each selected minion to its owner's graveyard
+    Bounce,         // Returns each selected minion to its owner's hand, unenchanted
+    Disenchant,     // Removes the top enchantment of each selected minion
+    Summon,         // card:u16 count:u8 - summons up to count copies for the owner
+    Resurrect,      // Returns the owner's top graveyard minion with 1 defense
+    GainCharges,    // n:i8 - the owner's ritual gains n charges
+    GainMagic,      // n:i8 - the owner gains n magic
+    DestroyRitual,  // Removes the target player's ritual
+    BranchIfRitual, // offset:u8 - skips offset bytes if the target is a ritual
+    Count
+};
+
+// Which minions a Select instruction picks
+enum class EffectScope : std::uint8_t {
+    Target,      // The chosen target, or the minion that caused a trigger
+    OwnTarget,   // As Target, but only if the owner controls it
+    EnemyTarget, // As Target, but only if the opponent controls it
+    Own,         // All of the owner's minions
+    Enemy,       // All of the opponent's minions
+    All,         // Every minion on the board
+    Self,        // The minion whose ability is running
+    Count
+};
+
+constexpr std::uint8_t op(EffectOp o) { return static_cast<std::uint8_t>(o); }
+constexpr std::uint8_t scope(EffectScope s) { return static_cast<std::uint8_t>(s); }
+
+// Number of operand bytes that follow each opcode
+constexpr std::size_t operandBytes(EffectOp o) {
+    switch (o) {
+        case EffectOp::Select: case EffectOp::Damage: case EffectOp::GainCharges:
+        case EffectOp::GainMagic: case EffectOp::BranchIfRitual:
+            return 1;
+        case EffectOp::Buff:
+            return 2;
+        case EffectOp::Summon:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+// A view of a compiled program. Programs are immutable and shared by every
+// card built from the same definition.
+struct EffectProgram {
+    const std::uint8_t* code = nullptr;
+    std::uint16_t size = 0;
+
+    constexpr bool empty() const { return size == 0; }
+};
+
+template <std::size_t N>
+constexpr EffectProgram program(const std::uint8_t (&code)[N]) {
+    return {code, static_cast<std::uint16_t>(N)};
+}
+
+// Where an effect is running. With 'lenient' set (triggers), a missing target
+// empties the selection instead of throwing.
+struct EffectContext {
+    Player* self;
+    Player* target_player;
+    int target_card_idx;
+    int source_idx; // Board slot of the minion running the effect, or -1
+    bool lenient;
+};
+
+void runEffect(EffectProgram program, const EffectContext& ctx);
+
+// Checks that a program is well formed: known opcodes and scopes, operands
+// inside the program, branches landing on instructions and a final Halt.
+// Returns an empty string if it is, otherwise what is wrong.
+std::string verifyEffect(EffectProgram program);
+
+// Human-readable listing, e.g. "select target; damage 1; halt"
+std::string disassembleEffect(EffectProgram program);
+
+// Stable 64-bit hash of the bytecode, for caching results per effect
+std::uint64_t hashEffect(EffectProgram program);
+
+// What a program does with the target it is given: select it as a minion,
+// or act on it as a ritual (branch on it, or remove the target's ritual)
+struct EffectTargets {
+    bool minion = false;
+    bool ritual = false;
+};
+EffectTargets effectTargets(EffectProgram program);
+
+#endif
@@ -1,8 +1,32 @@
 #include "enchantment.h"
 #include "player.h"
 #include "game.h"
+#include "cardtable.h"
 #include <stdexcept>
 
+namespace {
+
+CardFace statEnchantmentFace(const std::string& name, int cost, const char* attack, const char* defense) {
+    CardFace f;
+    f.layout = CardFace::Layout::StatEnchantment;
+    f.name = name;
+    f.cost = cost;
+    f.attackText = attack;
+    f.defenseText = defense;
+    return f;
+}
+
+CardFace enchantmentFace(const std::string& name, int cost, const char* desc) {
+    CardFace f;
+    f.layout = CardFace::Layout::Enchantment;
+    f.name = name;
+    f.cost = cost;
+    f.desc = desc;
+    return f;
+}
+
+} // namespace
+
 // --- Base Enchantment ---
 Enchantment::Enchantment(const std::string& name, int cost, Player* owner, std::shared_ptr<Minion> component)
     : Minion(name, cost, owner, 0, 0), component(component) {
@@ -33,7 +57,8 @@ int Enchantment::getDefense() const { return component->getDefense(); }
 int Enchantment::getActions() const { return component->getActions(); }
 std::shared_ptr<Ability> Enchantment::getAbility() const { return component->getAbility(); }
 int Enchantment::getAbilityCost() const { return component->getAbilityCost(); }
-card_template_t Enchantment::renderBase() const { return component->renderBase(); }
+CardFace Enchantment::faceBase() const { return component->faceBase(); }
+CardId Enchantment::getBaseId() const { return component->getBaseId(); }
 std::vector<std::shared_ptr<Enchantment>> Enchantment::getEnchantments() const {
     auto sub_list = component->getEnchantments();
     // We need to cast 'this' to get a shared_ptr to ourself to add to the list.
@@ -48,28 +73,34 @@ std::shared_ptr<Minion> Enchantment::getComponent() const { return component; }
 
 // --- Giant Strength ---
 GiantStrength::GiantStrength(Player* owner, std::shared_ptr<Minion> component)
-    : Enchantment("Giant Strength", 1, owner, component) {}
+    : Enchantment(cardDef(CardId::GiantStrength).name, cardDef(CardId::GiantStrength).cost, owner, component) {
+    this->id = CardId::GiantStrength;
+}
 int GiantStrength::getAttack() const { return component->getAttack() + 2; }
 int GiantStrength::getDefense() const { return component->getDefense() + 2; }
-card_template_t GiantStrength::render() const {
-    return display_enchantment_attack_defence(name, cost, "", "+2", "+2");
+CardFace GiantStrength::face() const {
+    return statEnchantmentFace(name, cost, "+2", "+2");
 }
 
 // --- Enrage ---
 Enrage::Enrage(Player* owner, std::shared_ptr<Minion> component)
-    : Enchantment("Enrage", 2, owner, component) {}
+    : Enchantment(cardDef(CardId::Enrage).name, cardDef(CardId::Enrage).cost, owner, component) {
+    this->id = CardId::Enrage;
+}
 int Enrage::getAttack() const { return component->getAttack() * 2; }
 int Enrage::getDefense() const { return component->getDefense() * 2; }
-card_template_t Enrage::render() const {
-    return display_enchantment_attack_defence(name, cost, "", "*2", "*2");
+CardFace Enrage::face() const {
+    return statEnchantmentFace(name, cost, "*2", "*2");
 }
 
 // --- Haste ---
 Haste::Haste(Player* owner, std::shared_ptr<Minion> component)
-    : Enchantment("Haste", 1, owner, component) {}
+    : Enchantment(cardDef(CardId::Haste).name, cardDef(CardId::Haste).cost, owner, component) {
+    this->id = CardId::Haste;
+}
 int Haste::getActions() const { return component->getActions() + 1; }
-card_template_t Haste::render() const {
-    return display_enchantment(name, cost, "Enchanted minion gains +1 action each turn");
+CardFace Haste::face() const {
+    return enchantmentFace(name, cost, cardDef(id).desc);
 }
 void Haste::play(Player* p, Player* t, int i) {
     Enchantment::play(p, t, i); // Do the base play logic
@@ -80,16 +111,20 @@ void Haste::play(Player* p, Player* t, int i) {
 
 // --- Magic Fatigue ---
 MagicFatigue::MagicFatigue(Player* owner, std::shared_ptr<Minion> component)
-    : Enchantment("Magic Fatigue", 0, owner, component) {}
+    : Enchantment(cardDef(CardId::MagicFatigue).name, cardDef(CardId::MagicFatigue).cost, owner, component) {
+    this->id = CardId::MagicFatigue;
+}
 int MagicFatigue::getAbilityCost() const { return component->getAbilityCost() + 2; }
-card_template_t MagicFatigue::render() const {
-    return display_enchantment(name, cost, "Enchanted minion's activated ability costs 2 more");
+CardFace MagicFatigue::face() const {
+    return enchantmentFace(name, cost, cardDef(id).desc);
 }
 
 // --- Silence ---
 Silence::Silence(Player* owner, std::shared_ptr<Minion> component)
-    : Enchantment("Silence", 1, owner, component) {}
+    : Enchantment(cardDef(CardId::Silence).name, cardDef(CardId::Silence).cost, owner, component) {
+    this->id = CardId::Silence;
+}
 std::shared_ptr<Ability> Silence::getAbility() const { return nullptr; }
-card_template_t Silence::render() const {
-    return display_enchantment(name, cost, "Enchanted minion cannot use abilities");
+CardFace Silence::face() const {
+    return enchantmentFace(name, cost, cardDef(id).desc);
 }
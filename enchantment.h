@@ -22,7 +22,8 @@ public:
     int getActions() const override;
     std::shared_ptr<Ability> getAbility() const override;
     int getAbilityCost() const override;
-    card_template_t renderBase() const override;
+    CardFace faceBase() const override;
+    CardId getBaseId() const override;
     std::vector<std::shared_ptr<Enchantment>> getEnchantments() const override;
 
     // Decorator-specific methods
@@ -37,7 +38,7 @@ public:
     GiantStrength(Player* owner, std::shared_ptr<Minion> component = nullptr);
     int getAttack() const override;
     int getDefense() const override;
-    card_template_t render() const override;
+    CardFace face() const override;
 };
 
 class Enrage : public Enchantment {
@@ -45,14 +46,14 @@ public:
     Enrage(Player* owner, std::shared_ptr<Minion> component = nullptr);
     int getAttack() const override;
     int getDefense() const override;
-    card_template_t render() const override;
+    CardFace face() const override;
 };
 
 class Haste : public Enchantment {
 public:
     Haste(Player* owner, std::shared_ptr<Minion> component = nullptr);
     int getActions() const override;
-    card_template_t render() const override;
+    CardFace face() const override;
     void play(Player* p, Player* t, int i) override;
 };
 
@@ -60,14 +61,14 @@ class MagicFatigue : public Enchantment {
 public:
     MagicFatigue(Player* owner, std::shared_ptr<Minion> component = nullptr);
     int getAbilityCost() const override;
-    card_template_t render() const override;
+    CardFace face() const override;
 };
 
 class Silence : public Enchantment {
 public:
     Silence(Player* owner, std::shared_ptr<Minion> component = nullptr);
     std::shared_ptr<Ability> getAbility() const override;
-    card_template_t render() const override;
+    CardFace face() const override;
 };
 
 #endif
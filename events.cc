@@ -0,0 +1,80 @@
+#include "events.h"
+#include "carddb.h"
+#include <algorithm>
+#include <string>
+
+namespace {
+
+const char* const EVENT_NAMES[] = {
+    "turn-start", "turn-end", "draw", "discard", "play", "enter", "leave", "ritual-lost",
+    "attack", "ability", "trigger", "damage", "buff", "magic", "life", "error", "game-over", "await"
+};
+static_assert(sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0]) == static_cast<size_t>(EventType::Count),
+              "Every event type needs a name");
+
+} // namespace
+
+void writeJsonString(std::ostream& out, std::string_view s) {
+    static const char* const HEX = "0123456789abcdef";
+    out << '"';
+    for (char c : s) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (u < 0x20) {
+            out << "\\u00" << HEX[u >> 4] << HEX[u & 0xF];
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+const char* eventName(EventType type) { return EVENT_NAMES[static_cast<size_t>(type)]; }
+
+// --- EventBus ---
+
+void EventBus::subscribe(std::shared_ptr<EventSink> sink) { sinks.push_back(std::move(sink)); }
+
+void EventBus::unsubscribe(const EventSink* sink) {
+    sinks.erase(std::remove_if(sinks.begin(), sinks.end(),
+                               [sink](const std::shared_ptr<EventSink>& s) { return s.get() == sink; }),
+                sinks.end());
+}
+
+// --- JsonLinesSink ---
+
+JsonLinesSink::JsonLinesSink(std::ostream& out) : out(out) {}
+
+void JsonLinesSink::onEvent(const Event& event) {
+    out << "{\"e\":\"" << eventName(event.type) << '"';
+    if (event.player) out << ",\"p\":" << event.player;
+    if (event.slot >= 0) out << ",\"slot\":" << event.slot;
+    if (event.card != CardId::Invalid) {
+        out << ",\"card\":";
+        writeJsonString(out, CardDatabase::get(event.card).name);
+    }
+    switch (event.type) {
+    case EventType::Buff:
+        out << ",\"atk\":" << event.value << ",\"def\":" << event.value2;
+        break;
+    case EventType::Leave:
+    case EventType::Damage:
+    case EventType::Magic:
+    case EventType::Life:
+        out << ",\"n\":" << event.value;
+        break;
+    default:
+        break;
+    }
+    if (event.target) {
+        out << ",\"tp\":" << event.target;
+        if (event.target_slot >= 0) out << ",\"tslot\":" << event.target_slot;
+    }
+    if (!event.text.empty()) {
+        out << ",\"msg\":";
+        writeJsonString(out, event.text);
+    }
+    // Flushed per event, so a bot on the other end of a pipe sees it at once
+    out << '}' << std::endl;
+}
@@ -0,0 +1,87 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "card.h"
+
+// Every state change the game reports. Records are small and built on the
+// stack, so emitting with no sinks attached costs next to nothing. A play or
+// ability is reported once it is paid for; if it then fails, an Error event
+// follows and the refund shows up as a Magic event.
+enum class EventType : std::uint8_t {
+    TurnStart,  // player
+    TurnEnd,    // player
+    Draw,       // player, card
+    Discard,    // player, card
+    Play,       // player, card, target/target_slot if targeted
+    Enter,      // player, slot, card - a minion entered play
+    Leave,      // player, slot, card, value 1 if it went to the graveyard
+    RitualLost, // player, card
+    Attack,     // player, slot (attacker), target, target_slot (-1 for the player)
+    Ability,    // player, slot, card, target/target_slot if targeted
+    Trigger,    // player, slot, card
+    Damage,     // player, slot, card, value (amount)
+    Buff,       // player, slot, card, value (attack), value2 (defense)
+    Magic,      // player, value (new total)
+    Life,       // player, value (new total)
+    Error,      // text
+    GameOver,   // player (winner, 0 if quit)
+    Await,      // player - the game is waiting for this player's command
+    Count
+};
+
+// Board slot of the ritual in events, matching the 'r' target of commands
+constexpr int RITUAL_SLOT = 5;
+
+struct Event {
+    EventType type;
+    int player = 0;
+    int slot = -1;
+    CardId card = CardId::Invalid;
+    int value = 0;
+    int target = 0; // Target player, or 0
+    int target_slot = -1;
+    std::string_view text = {};
+    int value2 = 0;
+};
+
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+    virtual void onEvent(const Event& event) = 0;
+};
+
+// Fans each event out to the attached sinks, in the order they were attached
+class EventBus {
+    std::vector<std::shared_ptr<EventSink>> sinks;
+
+public:
+    void subscribe(std::shared_ptr<EventSink> sink);
+    void unsubscribe(const EventSink* sink);
+    bool empty() const { return sinks.empty(); }
+
+    void emit(const Event& event) {
+        for (const auto& sink : sinks) sink->onEvent(event);
+    }
+};
+
+// One JSON object per line, e.g. {"e":"damage","p":2,"slot":0,"card":"Air Elemental","n":1}.
+// Keys: e (event name), p (player), slot, card (name), n (value; atk and def
+// for buffs), tp and tslot (target player and slot) and msg (error text). Keys
+// that don't apply to an event are left out.
+class JsonLinesSink : public EventSink {
+    std::ostream& out;
+
+public:
+    explicit JsonLinesSink(std::ostream& out);
+    void onEvent(const Event& event) override;
+};
+
+const char* eventName(EventType type);
+// Writes s as a quoted, escaped JSON string
+void writeJsonString(std::ostream& out, std::string_view s);
+
+#endif
@@ -1,19 +1,31 @@
 #include "game.h"
 #include "cardfactory.h"
+#include "renderer.h"
+#include "savefile.h"
+#include "solver.h"
+#include "bot.h"
+#include "actions.h"
+#include "profile.h"
+#include "trace.h"
+#include "memstats.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
-#include <random>
 #include <chrono>
 
 // Constructor: Initializes game settings and prepares for setup
 Game::Game(const std::string& d1, const std::string& d2, const std::string& init, bool testing, bool graphics)
-    : deck1_file(d1), deck2_file(d2), init_file(init), testing_mode(testing), graphics_mode(graphics) {
+    : Game(d1, d2, init, testing, graphics, std::cout, std::cerr) {}
+
+Game::Game(const std::string& d1, const std::string& d2, const std::string& init, bool testing, bool graphics,
+           std::ostream& out, std::ostream& err)
+    : deck1_file(d1), deck2_file(d2), init_file(init), testing_mode(testing), graphics_mode(graphics),
+      output(out, err), rng(std::chrono::system_clock::now().time_since_epoch().count()) {
     if (!init_file.empty()) {
         init_fs = std::make_unique<std::ifstream>(init_file);
         if (!init_fs->is_open()) {
-            std::cerr << "Error: Could not open init file " << init_file << std::endl;
+            output.error() << "Error: Could not open init file " << init_file << '\n';
             // Fallback to not using an init file
             init_fs.reset(); 
         }
@@ -22,23 +34,38 @@ Game::Game(const std::string& d1, const std::string& d2, const std::string& init
 
 Game::~Game() {}
 
-// Sets up the players, decks, and initial game state
-void Game::setup() {
-    std::istream& in = init_fs ? *init_fs : std::cin;
-    
-    std::string p1_name, p2_name;
-    std::cout << "Enter Player 1's name: " << std::endl;
-    std::getline(in, p1_name);
-    std::cout << "Enter Player 2's name: " << std::endl;
-    std::getline(in, p2_name);
+void Game::promptName(int player_id) {
+    output.info() << "Enter Player " << player_id << "'s name: \n";
+}
 
+void Game::createPlayers(const std::string& p1_name, const std::string& p2_name) {
     player1 = std::make_unique<Player>(1, p1_name, this);
     player2 = std::make_unique<Player>(2, p2_name, this);
     board = std::make_unique<Board>(this);
+    activePlayer = player1.get();
+    nonActivePlayer = player2.get();
+}
+
+// Sets up the players, decks, and initial game state
+void Game::setup(const std::string& p1_name, const std::string& p2_name) {
+    createPlayers(p1_name, p2_name);
 
     player1->loadDeck(deck1_file);
     player2->loadDeck(deck2_file);
+    dealHands();
+}
+
+void Game::deal(const std::vector<CardId>& deck1, const std::vector<CardId>& deck2) {
+    if (!player1) createPlayers("Player 1", "Player 2");
+    player1->reset(deck1);
+    player2->reset(deck2);
+    activePlayer = player1.get();
+    nonActivePlayer = player2.get();
+    dealHands();
+}
 
+// Shuffles the decks (unless testing) and draws the opening hands
+void Game::dealHands() {
     if (!testing_mode) {
         player1->shuffleDeck();
         player2->shuffleDeck();
@@ -48,75 +75,257 @@ void Game::setup() {
         player1->drawCard();
         player2->drawCard();
     }
-    
-    activePlayer = player1.get();
-    nonActivePlayer = player2.get();
+    if (trace::enabled()) turn_started = trace::now();
 }
 
-// Main game loop
+// Main game loop: feeds the resumable loop from the init file, then std::cin
 void Game::run() {
-    setup();
-
     std::string line;
     std::istream* current_in = init_fs ? init_fs.get() : &std::cin;
 
-    while (true) {
-        board->display();
-        std::cout << activePlayer->getName() << "'s turn:" << std::endl;
+    // While fast-forwarding, only errors get through
+    const OutputLevel level = output.getLevel();
+    bool skipping = fast_forward && current_in == init_fs.get();
+    if (skipping) output.setLevel(std::max(level, OutputLevel::Error));
+    auto catchUp = [&] {
+        if (!skipping) return;
+        skipping = false;
+        output.setLevel(level);
+        GameOutput::Batch batch(output);
+        if (isOver()) {
+            if (int winner = getWinner()) announceWinner(winner);
+        } else {
+            reprompt();
+        }
+    };
+
+    start();
+    while (!isOver()) {
+        if (renderer) renderer->publish();
 
         if (current_in->eof()) {
             if (current_in == init_fs.get()) {
                 current_in = &std::cin; // Switch to standard input
+                catchUp();
             } else {
                 break; // EOF from std::cin
             }
         }
 
-        if (!std::getline(*current_in, line)) {
+        // The bot's seat plays itself once the init file is done
+        if (bot && stage == Stage::Command && activePlayer->getPlayerId() == bot_player) {
+            if (current_in == init_fs.get() && current_in->peek() == std::char_traits<char>::eof()) {
+                current_in = &std::cin;
+                catchUp();
+            }
+            if (current_in == &std::cin) {
+                line = actionCommand(bot->choose(*this));
+                output.info() << activePlayer->getName() << ": " << line << '\n';
+                resume(line);
+                continue;
+            }
+        }
+
+        // While the player thinks, so does the bot, until the read is over
+        // however it ends: at the end of input, std::cin throws
+        bool read;
+        {
+            struct PonderGuard {
+                AnytimeBot* bot;
+                ~PonderGuard() {
+                    if (bot) bot->stopPondering();
+                }
+            } guard{bot && stage == Stage::Command && current_in == &std::cin ? bot : nullptr};
+            if (guard.bot) guard.bot->ponder(*this, bot_player);
+            read = static_cast<bool>(std::getline(*current_in, line));
+        }
+        if (!read) {
              if (current_in == init_fs.get()) {
                 current_in = &std::cin; // Switch to standard input
+                catchUp();
                 if (!std::getline(*current_in, line)) break;
             } else {
                 break; // EOF from std::cin
             }
         }
 
-        std::stringstream ss(line);
-        std::string cmd;
-        ss >> cmd;
+        resume(line);
+    }
+    catchUp(); // The init file ended the game
+}
 
-        if (cmd.empty()) continue;
+void Game::setFastForward(bool on) { fast_forward = on; }
 
-        try {
-            process_command(cmd, ss);
-        } catch (const std::exception& e) {
-            std::string errMsg = e.what();
-            if (errMsg == "Game quit by user.") {
-                std::cerr << e.what() << std::endl;
-                return;
+void Game::setBot(int player, AnytimeBot* b) {
+    bot = b;
+    bot_player = player;
+}
+
+void Game::start() {
+    if (stage != Stage::NotStarted) return;
+    GameOutput::Batch batch(output);
+    promptName(1);
+    stage = Stage::Player1Name;
+}
+
+// Runs the loop from where it stopped, with the line it was waiting for, up
+// to the point where it needs the next one
+void Game::resume(const std::string& line) {
+    MEM_GAME(mem);
+    GameOutput::Batch batch(output); // Everything a line prints goes out at once
+    switch (stage) {
+        case Stage::NotStarted:
+        case Stage::Over:
+            return;
+        case Stage::Player1Name:
+            p1_name = line;
+            promptName(2);
+            stage = Stage::Player2Name;
+            return;
+        case Stage::Player2Name:
+            setup(p1_name, line);
+            p1_name = std::string();
+            prompt();
+            stage = Stage::Command;
+            events.emit({EventType::Await, activePlayer->getPlayerId()});
+            return;
+        case Stage::Command:
+            if (step(line)) {
+                prompt();
+                events.emit({EventType::Await, activePlayer->getPlayerId()});
             }
-            std::cerr << "Error: " << e.what() << std::endl;
-        }
+            return;
+    }
+}
+
+void Game::prompt() {
+    board->display();
+    output.info() << activePlayer->getName() << "'s turn:\n";
+}
+
+void Game::reprompt() {
+    switch (stage) {
+        case Stage::Player1Name: promptName(1); break;
+        case Stage::Player2Name: promptName(2); break;
+        case Stage::Command: prompt(); break;
+        default: break;
+    }
+}
 
-        if (player1->getLife() <= 0) {
-            std::cout << player2->getName() << " wins!" << std::endl;
-            break;
+void Game::announceWinner(int winner) { output.info() << getPlayer(winner)->getName() << " wins!\n"; }
+
+// Runs one line of input as a command, then checks whether anyone has won
+bool Game::step(const std::string& line) {
+    if (stage == Stage::Over) return false;
+    PROFILE_PHASE(Phase::Command);
+    MEM_CATEGORY(MemCategory::Commands);
+
+    std::stringstream ss(line);
+    std::string cmd;
+    ss >> cmd;
+
+    if (cmd.empty()) return true;
+    trace::Span span("command", {activePlayer->getPlayerId(), -1, CardId::Invalid, 0, -1, cmd});
+
+    try {
+        process_command(cmd, ss);
+        removeDeadMinions();
+    } catch (const std::exception& e) {
+        std::string errMsg = e.what();
+        if (errMsg == "Game quit by user.") {
+            output.error() << e.what() << '\n';
+            stage = Stage::Over;
+            events.emit({EventType::GameOver});
+            return false;
         }
-        if (player2->getLife() <= 0) {
-            std::cout << player1->getName() << " wins!" << std::endl;
-            break;
+        output.error() << "Error: " << e.what() << '\n';
+        events.emit({EventType::Error, 0, -1, CardId::Invalid, 0, 0, -1, errMsg});
+    }
+
+    if (int winner = getWinner()) {
+        announceWinner(winner);
+        stage = Stage::Over;
+        events.emit({EventType::GameOver, winner});
+    }
+    return stage != Stage::Over;
+}
+
+void Game::endTurn() { switch_turns(); }
+
+void Game::removeDeadMinions() {
+    // Leave triggers can kill more minions, so sweep until nothing dies.
+    // Slots are checked from the right since removing one shifts the rest left.
+    bool removed = true;
+    while (removed) {
+        removed = false;
+        for (Player* p : {activePlayer, nonActivePlayer}) {
+            auto& minions = p->getMinions();
+            for (int i = 4; i >= 0; --i) {
+                if (minions[i] && minions[i]->isDead()) {
+                    p->removeMinion(i, true);
+                    removed = true;
+                }
+            }
         }
     }
 }
 
+int Game::getWinner() {
+    if (player1->getLife() <= 0) return 2;
+    if (player2->getLife() <= 0) return 1;
+    return 0;
+}
+
+void Game::seed(unsigned s) { rng.seed(s); }
+Rng& Game::getRng() { return rng; }
+
+void Game::setActivePlayer(int id) {
+    activePlayer = getPlayer(id);
+    nonActivePlayer = getPlayer(3 - id);
+}
+
+// --- Saving ---
+
+std::uint64_t Game::save(const std::string& filename) {
+    return AsyncFileWriter::instance().write(filename, encodeSave(getSaveData()));
+}
+
+void Game::load(const std::string& filename) {
+    GameOutput::Batch batch(output);
+    restore(readSaveFile(filename));
+    prompt();
+    events.emit({EventType::Await, activePlayer->getPlayerId()});
+}
+
+SaveData Game::getSaveData() {
+    SaveData data;
+    data.names[0] = player1->getName();
+    data.names[1] = player2->getName();
+    data.rng = rng.state();
+    data.position = packState(*this);
+    return data;
+}
+
+void Game::restore(const SaveData& data) {
+    createPlayers(data.names[0], data.names[1]);
+    rng.setState(data.rng);
+    unpackState(data.position, *this);
+    stage = Stage::Command;
+    if (trace::enabled()) turn_started = trace::now();
+}
+
+void Game::setAutosave(const std::string& filename) { autosave_file = filename; }
+
+bool Game::isOver() const { return stage == Stage::Over; }
+
 
 // Processes a single command from the input stream
 void Game::process_command(const std::string& cmd, std::istream& in) {
     if (cmd == "help") {
-        std::cout << "Commands: help, end, quit, attack, play, use, inspect, hand, board" << std::endl;
-        if(testing_mode) std::cout << "Testing Commands: draw, discard" << std::endl;
+        output.info() << "Commands: help, end, quit, attack, play, use, inspect, hand, board, save, solve, stats, memstats\n";
+        if(testing_mode) output.info() << "Testing Commands: draw, discard\n";
     } else if (cmd == "end") {
-        switch_turns();
+        endTurn();
     } else if (cmd == "quit") {
         throw std::runtime_error("Game quit by user.");
     } else if (cmd == "draw" && testing_mode) {
@@ -126,7 +335,7 @@ void Game::process_command(const std::string& cmd, std::istream& in) {
         if (in >> i) {
             activePlayer->discard(i - 1);
         } else {
-            std::cout << "Invalid discard command." << std::endl;
+            output.info() << "Invalid discard command.\n";
         }
     } else if (cmd == "attack") {
         int i, j;
@@ -137,7 +346,7 @@ void Game::process_command(const std::string& cmd, std::istream& in) {
                 activePlayer->attack(i - 1);
             }
         } else {
-            std::cout << "Invalid attack command." << std::endl;
+            output.info() << "Invalid attack command.\n";
         }
     } else if (cmd == "play") {
         int i, p, t_val;
@@ -155,7 +364,7 @@ void Game::process_command(const std::string& cmd, std::istream& in) {
                 activePlayer->play(i - 1);
             }
         } else {
-            std::cout << "Invalid play command." << std::endl;
+            output.info() << "Invalid play command.\n";
         }
     } else if (cmd == "use") {
         int i, p, t_val;
@@ -172,25 +381,86 @@ void Game::process_command(const std::string& cmd, std::istream& in) {
                 activePlayer->use(i - 1);
             }
         } else {
-            std::cout << "Invalid use command." << std::endl;
+            output.info() << "Invalid use command.\n";
         }
     } else if (cmd == "inspect") {
         int i;
         if (in >> i) {
             board->inspectMinion(activePlayer->getPlayerId(), i - 1);
         } else {
-            std::cout << "Invalid inspect command." << std::endl;
+            output.info() << "Invalid inspect command.\n";
         }
     } else if (cmd == "hand") {
         board->displayHand(activePlayer->getPlayerId());
     } else if (cmd == "board") {
         board->display();
+    } else if (cmd == "save") {
+        std::string file;
+        if (in >> file) {
+            // Unlike an autosave, waits to say whether it worked
+            std::string error = AsyncFileWriter::instance().wait(save(file));
+            if (!error.empty()) throw std::runtime_error(error);
+            output.info() << "Saved game to " << file << ".\n";
+        } else {
+            output.info() << "Invalid save command.\n";
+        }
+    } else if (cmd == "solve") {
+        int depth;
+        double seconds = 10;
+        if (in >> depth && depth > 0) {
+            in >> seconds;
+            solve(std::min(depth, 64), seconds);
+        } else {
+            output.info() << "Invalid solve command.\n";
+        }
+    } else if (cmd == "stats") {
+        profile::report(output.info());
+        if (bot) bot->report(output.info());
+    } else if (cmd == "memstats") {
+        printMemstats();
     } else {
-        std::cout << "Unknown command: " << cmd << std::endl;
+        output.info() << "Unknown command: " << cmd << '\n';
     }
 }
 
 
+// Prints what this game has allocated, in all and by turn
+void Game::printMemstats() {
+    std::ostream& out = output.info();
+    out << "This game:\n";
+    memstats::report(out, mem);
+    if (!SORCERY_MEMSTATS) return;
+    out << "This turn so far:\n";
+    memstats::report(out, mem - mem_turn_start);
+    out << "Last turn:\n";
+    memstats::report(out, mem_last_turn);
+    out << "Heap in use by the process: " << memstats::live() << " bytes\n";
+}
+
+// Searches for a forced win, printing each depth as it completes
+void Game::solve(int depth, double seconds) {
+    const std::string& name = activePlayer->getName();
+    auto turns = [](int n) { return std::to_string(n) + (n == 1 ? " turn" : " turns"); };
+    std::ostream& out = output.info();
+    Solver solver;
+    SolveResult result = solver.solve(*this, depth, seconds, [&](const SolveResult& r) {
+        out << "Depth " << r.depth << ": " << r.nodes << " nodes in " << r.seconds << "s ("
+            << static_cast<long>(r.nodes / std::max(r.seconds, 1e-6)) << " nodes/s)";
+        if (r.best >= 0) out << ", best move " << actionCommand(r.best);
+        out << std::endl; // Each depth as soon as it is done
+    });
+    if (result.outcome > 0) {
+        out << name << " wins by force within " << turns(result.turns) << ": " << actionCommand(result.best)
+            << '\n';
+    } else if (result.outcome < 0) {
+        out << name << " loses by force within " << turns(result.turns) << ".\n";
+    } else {
+        out << "No forced result within " << turns(result.depth);
+        if (result.depth < depth) out << " (ran out of time)";
+        out << ".\n";
+    }
+}
+
 // Switches the active player and handles turn start/end logic
 void Game::switch_turns() {
     end_turn();
@@ -202,25 +472,58 @@ void Game::switch_turns() {
         nonActivePlayer = player2.get();
     }
     start_turn();
+    // The turn has changed whatever happens to the file, so a failed
+    // autosave is reported without failing the command that ended the turn.
+    // Earlier autosaves still being written are reported a turn later.
+    if (!autosave_file.empty()) {
+        AsyncFileWriter& writer = AsyncFileWriter::instance();
+        std::string error;
+        for (auto it = autosaves.begin(); it != autosaves.end();) {
+            if (!writer.poll(*it, error)) {
+                ++it;
+                continue;
+            }
+            if (!error.empty()) output.error() << "Autosave failed: " << error << '\n';
+            it = autosaves.erase(it);
+        }
+        try {
+            autosaves.push_back(save(autosave_file));
+        } catch (const std::exception& e) {
+            output.error() << "Autosave failed: " << e.what() << '\n';
+        }
+    }
 }
 
 // Logic for the start of a player's turn
 void Game::start_turn() {
+    events.emit({EventType::TurnStart, activePlayer->getPlayerId()});
     activePlayer->gainMagic(1);
     activePlayer->drawCard();
     activePlayer->resetMinionActions();
     execute_triggers(TriggerType::StartOfTurn);
+    if (trace::enabled()) turn_started = trace::now();
+    if (SORCERY_MEMSTATS) {
+        mem_last_turn = mem - mem_turn_start;
+        mem_turn_start = mem;
+    }
 }
 
 // Logic for the end of a player's turn
 void Game::end_turn() {
     execute_triggers(TriggerType::EndOfTurn);
+    events.emit({EventType::TurnEnd, activePlayer->getPlayerId()});
+    // Each game's turns get a track of their own
+    if (turn_started) {
+        trace::complete("turn", turn_started, {activePlayer->getPlayerId()}, reinterpret_cast<std::uintptr_t>(this));
+    }
+    turn_started = 0;
 }
 
 // Executes all triggers of a certain type in APNAP order
 void Game::execute_triggers(TriggerType type, std::shared_ptr<Minion> target) {
     // APNAP order: Active Player's Minions, Active Player's Ritual,
     // Non-Active Player's Minions, Non-Active Player's Ritual.
+    PROFILE_PHASE(Phase::Triggers);
 
     // Active Player Minions
     for (auto& minion : activePlayer->getMinions()) {
@@ -241,6 +544,9 @@ void Game::execute_triggers(TriggerType type, std::shared_ptr<Minion> target) {
     }
 }
 
+void Game::notifyTurnStart() { execute_triggers(TriggerType::StartOfTurn); }
+void Game::notifyTurnEnd() { execute_triggers(TriggerType::EndOfTurn); }
+
 // Notifies the game that a minion has entered play
 void Game::notifyMinionEnters(std::shared_ptr<Minion> m) {
     execute_triggers(TriggerType::MinionEnters, m);
@@ -262,3 +568,22 @@ Player* Game::getActivePlayer() { return activePlayer; }
 Player* Game::getNonActivePlayer() { return nonActivePlayer; }
 Board* Game::getBoard() { return board.get(); }
 bool Game::isTestingMode() { return testing_mode; }
+GameOutput& Game::getOutput() { return output; }
+Renderer* Game::getRenderer() { return renderer; }
+void Game::setRenderer(Renderer* r) { renderer = r; }
+EventBus& Game::getEvents() { return events; }
+
+// --- ScratchGame ---
+
+ScratchGame::ScratchGame() : discard(std::make_unique<std::ostream>(nullptr)) {}
+
+ScratchGame::~ScratchGame() {}
+
+Game& ScratchGame::get(bool testing_mode) {
+    if (!game || testing != testing_mode) {
+        testing = testing_mode;
+        game = std::make_unique<Game>("", "", "", testing, false, *discard, *discard);
+        game->deal({}, {});
+    }
+    return *game;
+}
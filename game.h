@@ -4,6 +4,7 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <iosfwd>
 #include "player.h"
 #include "board.h"
 #include "card.h"
@@ -12,6 +13,14 @@
 #include "spell.h"
 #include "enchantment.h"
 #include "ability.h"
+#include "events.h"
+#include "rng.h"
+#include "memstats.h"
+#include "output.h"
+
+class Renderer;
+class AnytimeBot;
+struct SaveData;
 
 class Game {
     std::unique_ptr<Player> player1;
@@ -28,23 +37,107 @@ class Game {
     bool graphics_mode; // Note: Graphics mode is not implemented in this version
 
     std::unique_ptr<std::ifstream> init_fs; // Input stream for init file
+    bool fast_forward = false; // Run the init file without showing anything but errors
+
+    GameOutput output; // Where the game writes its board, messages and errors
+    Renderer* renderer = nullptr; // Draws the board on its own thread, if set
+    AnytimeBot* bot = nullptr; // Plays bot_player's seat in run(), if set
+    int bot_player = 0;
+    EventBus events; // Structured record of the game, for bots and spectators
+    Rng rng; // Shuffles the decks; seeded from the clock unless seed() is called
+    std::string autosave_file; // Saved at every turn change, if set
+    std::vector<std::uint64_t> autosaves; // Writer tickets of autosaves not yet known to be done
+    std::uint64_t turn_started = 0; // When the current turn began, while tracing
+    // Allocated while this game's loop ran (see memstats.h): in all, as of
+    // the start of this turn, and during the last turn
+    MemCounts mem;
+    MemCounts mem_turn_start;
+    MemCounts mem_last_turn;
+
+    // What the resumable loop is waiting for
+    enum class Stage { NotStarted, Player1Name, Player2Name, Command, Over };
+    Stage stage = Stage::NotStarted;
+    std::string p1_name; // Held until Player 2's name arrives
 
-    void setup();
+    void createPlayers(const std::string& p1_name, const std::string& p2_name);
+    void dealHands();
+    void promptName(int player_id);
+    void prompt(); // Shows the board and whose turn it is
+    void reprompt(); // Asks again for whatever the loop is waiting for
+    void announceWinner(int winner);
     void switch_turns();
     void start_turn();
     void end_turn();
     void process_command(const std::string& cmd, std::istream& in);
+    void solve(int depth, double seconds);
+    void printMemstats();
 
 public:
     Game(const std::string& d1, const std::string& d2, const std::string& init, bool testing, bool graphics);
+    Game(const std::string& d1, const std::string& d2, const std::string& init, bool testing, bool graphics,
+         std::ostream& out, std::ostream& err);
     ~Game();
 
+    // Plays a whole game, blocking on the init file and then std::cin for input
     void run();
+    // Makes run() play the init file with only errors shown, then show the
+    // board once when input moves to std::cin, so long scenarios load at the
+    // speed of the rules rather than of rendering
+    void setFastForward(bool on);
+    // Makes run() ask the bot for the player's commands once the init file
+    // has run out, showing each one as it is played
+    void setBot(int player, AnytimeBot* b);
+
+    // --- Resumable loop ---
+    // The same loop as run(), as a state machine that stops whenever it needs
+    // a line of input: a player name during setup, then a command. Callers
+    // that own the input (see server.h) call start() once, then resume() with
+    // each line until isOver(). Nothing blocks, so one thread can interleave
+    // any number of games.
+    void start();
+    void resume(const std::string& line);
+    bool isOver() const;
+
+    // --- Direct API ---
+    // For callers that drive the rules without the prompts and board display
+    void setup(const std::string& p1_name, const std::string& p2_name);
+    // setup() with decks of cards instead of the deck files. A game set up
+    // before keeps its players and board, so simulations can play game after
+    // game in one Game.
+    void deal(const std::vector<CardId>& deck1, const std::vector<CardId>& deck2);
+    bool step(const std::string& line); // Runs one command; false once the game is over
+    // The pieces of step() for callers using the Player action methods
+    void endTurn();
+    void removeDeadMinions(); // Sends minions with no defense left to the graveyard
+    int getWinner();          // 1 or 2 once the other player is out of life, otherwise 0
+    void seed(unsigned s);    // Before setup(), for a reproducible shuffle
+    void setActivePlayer(int id);
+    Rng& getRng();
+
+    // --- Saving ---
+    // Encodes the whole game (see savefile.h) and queues it for a background
+    // write, so it costs about as much as packing a position. Returns the
+    // write's ticket, from which AsyncFileWriter tells whether it worked.
+    std::uint64_t save(const std::string& filename);
+    // Instead of setup(): restores a saved game, ready for its next command
+    void load(const std::string& filename);
+    // The same without the files, and restore() prints nothing
+    SaveData getSaveData();
+    void restore(const SaveData& data);
+    void setAutosave(const std::string& filename);
+
     Player* getPlayer(int id);
     Player* getActivePlayer();
     Player* getNonActivePlayer();
     Board* getBoard();
     bool isTestingMode();
+    GameOutput& getOutput();
+    Renderer* getRenderer();
+    // The renderer should also be the game's output (see renderer.h), and
+    // run() publishes to it whenever the game waits for input
+    void setRenderer(Renderer* r);
+    // Sinks attached here see every state change as it happens (see events.h)
+    EventBus& getEvents();
 
     // Trigger notification methods
     void notifyMinionEnters(std::shared_ptr<Minion> m);
@@ -56,4 +149,21 @@ private:
     void execute_triggers(TriggerType type, std::shared_ptr<Minion> target = nullptr);
 };
 
+// A game for searches and simulations to unpack positions into (see
+// packed.h) or deal() into, with no deck files and its text thrown away.
+// Made on first use and kept, and made again only if a caller needs the
+// other testing-mode rules.
+class ScratchGame {
+    std::unique_ptr<std::ostream> discard;
+    std::unique_ptr<Game> game;
+    bool testing = false;
+
+public:
+    ScratchGame();
+    ~ScratchGame();
+
+    // Its players are dealt empty decks when it is made
+    Game& get(bool testing);
+};
+
 #endif
@@ -2,7 +2,23 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <fstream>
+#include <cstdlib>
+#include <algorithm>
 #include "game.h"
+#include "carddb.h"
+#include "server.h"
+#include "renderer.h"
+#include "events.h"
+#include "perft.h"
+#include "actions.h"
+#include "profile.h"
+#include "trace.h"
+#include "memstats.h"
+#include "corpus.h"
+#include "tournament.h"
+#include "decksearch.h"
+#include "bot.h"
 
 // Main function: Entry point of the program
 int main(int argc, char *argv[]) {
@@ -12,6 +28,39 @@ int main(int argc, char *argv[]) {
     std::string init_file = "";
     bool testing_mode = false;
     bool graphics_mode = false;
+    bool render_thread = false;
+    bool events_mode = false;    // Print the event stream instead of the board
+    bool quiet = false;          // Leave out trigger commentary (see output.h)
+    bool fast_forward = false;   // Play the init file without showing it
+    std::string resume_file = "";
+    std::string autosave_file = "";
+    std::string event_log = "";  // Also write the event stream here
+    std::vector<std::string> card_dbs;
+    std::string compiled_db = "";
+    bool list_cards = false;
+    std::string server_socket = ""; // "-" serves over stdin/stdout
+    unsigned server_workers = 0;
+    double hibernate_after = 0;     // Seconds idle before a hosted game hibernates
+    std::string hibernate_dir = "";
+    int perft_depth = 0;            // Count move sequences instead of playing
+    std::string corpus_dir = "";    // Replay and check a directory of scripts
+    bool record = false;            // With -corpus, save digests instead of checking them
+    bool tournament = false;        // Play the decks named on the command line against each other
+    std::vector<std::string> tournament_decks; // Also the gauntlet for -deck-search
+    std::string deck_search_file = ""; // Evolve a deck against the decks named and write it here
+    int generations = 0;            // For -deck-search; 0 is the default
+    int population = 0;
+    int deck_size = 0;
+    int tournament_games = 0;       // Most games per pair; 0 is the default
+    double tournament_delta = -1;   // Score difference the SPRT tests for; below 0 is the default
+    int threads = -1;               // For -perft, -corpus and -tournament; below 0 is the mode's default
+    bool seeded = false;
+    unsigned seed = 0;
+    int bot_player = 0;             // The seat the bot plays, if any
+    double think_ms = 50;           // The bot's time per move
+    bool ponder = true;             // The bot also thinks during the other player's turn
+    bool print_stats = false;       // Phase timings and allocations to stderr on exit
+    std::string trace_file = "";    // Chrome trace of the run (see trace.h)
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -31,19 +80,273 @@ int main(int argc, char *argv[]) {
             testing_mode = true;
         } else if (arg == "-graphics") {
             graphics_mode = true;
+        } else if (arg == "-render-thread") {
+            render_thread = true;
+        } else if (arg == "-resume") {
+            if (i + 1 < argc) {
+                resume_file = argv[++i];
+            }
+        } else if (arg == "-autosave") {
+            if (i + 1 < argc) {
+                autosave_file = argv[++i];
+            }
+        } else if (arg == "-fast-forward") {
+            fast_forward = true;
+        } else if (arg == "-quiet") {
+            quiet = true;
+        } else if (arg == "-events") {
+            events_mode = true;
+        } else if (arg == "-event-log") {
+            if (i + 1 < argc) {
+                event_log = argv[++i];
+            }
+        } else if (arg == "-cards") {
+            if (i + 1 < argc) {
+                card_dbs.push_back(argv[++i]);
+            }
+        } else if (arg == "-compile-cards") {
+            if (i + 1 < argc) {
+                compiled_db = argv[++i];
+            }
+        } else if (arg == "-list-cards") {
+            list_cards = true;
+        } else if (arg == "-server") {
+            if (i + 1 < argc) {
+                server_socket = argv[++i];
+            }
+        } else if (arg == "-workers") {
+            if (i + 1 < argc) {
+                server_workers = std::strtoul(argv[++i], nullptr, 10);
+            }
+        } else if (arg == "-hibernate") {
+            if (i + 1 < argc) {
+                hibernate_after = std::strtod(argv[++i], nullptr);
+            }
+        } else if (arg == "-hibernate-dir") {
+            if (i + 1 < argc) {
+                hibernate_dir = argv[++i];
+            }
+        } else if (arg == "-perft") {
+            if (i + 1 < argc) {
+                perft_depth = std::atoi(argv[++i]);
+            }
+        } else if (arg == "-corpus") {
+            if (i + 1 < argc) {
+                corpus_dir = argv[++i];
+            }
+        } else if (arg == "-record") {
+            record = true;
+        } else if (arg == "-tournament") {
+            tournament = true;
+        } else if (arg == "-deck-search") {
+            if (i + 1 < argc) {
+                deck_search_file = argv[++i];
+            }
+        } else if (arg == "-generations") {
+            if (i + 1 < argc) {
+                generations = std::atoi(argv[++i]);
+            }
+        } else if (arg == "-population") {
+            if (i + 1 < argc) {
+                population = std::atoi(argv[++i]);
+            }
+        } else if (arg == "-deck-size") {
+            if (i + 1 < argc) {
+                deck_size = std::atoi(argv[++i]);
+            }
+        } else if (arg == "-games") {
+            if (i + 1 < argc) {
+                tournament_games = std::atoi(argv[++i]);
+            }
+        } else if (arg == "-delta") {
+            if (i + 1 < argc) {
+                tournament_delta = std::strtod(argv[++i], nullptr);
+            }
+        } else if (arg == "-threads") {
+            if (i + 1 < argc) {
+                threads = std::atoi(argv[++i]);
+            }
+        } else if (arg == "-trace") {
+            if (i + 1 < argc) {
+                trace_file = argv[++i];
+            }
+        } else if (arg == "-bot") {
+            if (i + 1 < argc) {
+                bot_player = std::atoi(argv[++i]);
+            }
+        } else if (arg == "-think") {
+            if (i + 1 < argc) {
+                think_ms = std::strtod(argv[++i], nullptr);
+            }
+        } else if (arg == "-no-ponder") {
+            ponder = false;
+        } else if (arg == "-stats") {
+            print_stats = true;
+        } else if (arg == "-seed") {
+            if (i + 1 < argc) {
+                seed = std::strtoul(argv[++i], nullptr, 10);
+                seeded = true;
+            }
+        } else if (arg[0] != '-') {
+            tournament_decks.push_back(arg);
         }
     }
 
+    // Reports on every way out of main, after the game and renderer are gone
+    std::unique_ptr<AnytimeBot> bot;
+    struct StatsOnExit {
+        bool enabled;
+        const std::unique_ptr<AnytimeBot>& bot;
+        ~StatsOnExit() {
+            trace::stop();
+            if (!enabled) return;
+            profile::report(std::cerr);
+            if (bot) {
+                bot->stopPondering(); // Its counts are the ponderer's until then
+                bot->report(std::cerr);
+            }
+            std::cerr << "Allocations:" << std::endl;
+            memstats::report(std::cerr, memstats::process());
+        }
+    } stats_on_exit{print_stats, bot};
+
     // --- Game Initialization ---
-    // The 'cin.exceptions(ios::eofbit)' line is crucial for handling Ctrl-D (EOF)
-    // as an exception, which allows the program to terminate gracefully when input
-    // is redirected from a file that ends, or when the user signals EOF.
-    std::cin.exceptions(std::ios::eofbit);
     try {
-        // Create the game object with the parsed settings
-        auto game = std::make_unique<Game>(deck1_file, deck2_file, init_file, testing_mode, graphics_mode);
+        // Load any extra card databases before a single card is created
+        for (const auto& db : card_dbs) {
+            CardDatabase::load(db);
+        }
+        if (!trace_file.empty()) trace::start(trace_file);
+        if (!compiled_db.empty()) {
+            CardDatabase::compile(compiled_db);
+            return 0;
+        }
+        if (list_cards) {
+            // One line per card: id, name, effect hash and disassembled bytecode
+            for (size_t id = 0; id < CardDatabase::size(); ++id) {
+                const CardDef& def = CardDatabase::get(static_cast<CardId>(id));
+                std::cout << id << '\t' << def.name << '\t' << std::hex << hashEffect(def.effect) << std::dec
+                          << '\t' << disassembleEffect(def.effect) << std::endl;
+            }
+            return 0;
+        }
+
+        if (perft_depth > 0) {
+            // From the start of a game shuffled with the seed: the count under
+            // each first action, then the total and the speed
+            std::ostream discard(nullptr);
+            Game game(deck1_file, deck2_file, "", testing_mode, false, discard, std::cerr);
+            game.seed(seeded ? seed : 1);
+            game.setup("Player 1", "Player 2");
+            PerftResult result = perft(game, perft_depth, threads < 0 ? 1 : threads);
+            for (const auto& [action, nodes] : result.divide) {
+                std::cout << actionCommand(action) << ": " << nodes << std::endl;
+            }
+            std::cout << "perft " << perft_depth << ": " << result.nodes << " nodes in " << result.seconds << "s ("
+                      << static_cast<long>(result.nodes / std::max(result.seconds, 1e-6)) << " nodes/s)" << std::endl;
+            return 0;
+        }
+
+        if (!corpus_dir.empty()) {
+            // One line per script, then the totals; see corpus.h
+            CorpusOptions options;
+            options.dir = corpus_dir;
+            options.deck1_file = deck1_file;
+            options.deck2_file = deck2_file;
+            options.testing = testing_mode;
+            options.record = record;
+            options.threads = threads < 0 ? 0 : threads;
+            if (seeded) options.seed = seed;
+            return runCorpus(options, std::cout) ? 1 : 0;
+        }
+
+        if (tournament) {
+            // A line per pair as it finishes, then the table; see tournament.h
+            TournamentOptions options;
+            options.decks = tournament_decks;
+            if (tournament_games > 0) options.games = tournament_games;
+            if (tournament_delta >= 0) options.delta = tournament_delta;
+            options.threads = threads < 0 ? 0 : threads;
+            if (seeded) options.seed = seed;
+            runTournament(options, std::cout);
+            return 0;
+        }
+
+        if (!deck_search_file.empty()) {
+            // A line per generation, then the best deck; see decksearch.h
+            DeckSearchOptions options;
+            options.gauntlet = tournament_decks;
+            if (generations > 0) options.generations = generations;
+            if (population > 0) options.population = population;
+            if (deck_size > 0) options.deck_size = deck_size;
+            if (tournament_games > 0) options.games = tournament_games;
+            options.threads = threads < 0 ? 0 : threads;
+            if (seeded) options.seed = seed;
+            writeDeck(deck_search_file, runDeckSearch(options, std::cout).best);
+            return 0;
+        }
+
+        if (!server_socket.empty()) {
+            // Host any number of games; see server.h for the protocol
+            ServerOptions options;
+            options.deck1_file = deck1_file;
+            options.deck2_file = deck2_file;
+            options.testing = testing_mode;
+            options.workers = server_workers;
+            options.events = events_mode;
+            options.hibernate_after = hibernate_after;
+            options.hibernate_dir = hibernate_dir;
+            GameServer server(options);
+            if (server_socket == "-") {
+                server.serveStdio();
+            } else {
+                server.serveSocket(server_socket);
+            }
+            return 0;
+        }
+
+        // Create the game object with the parsed settings. With a render
+        // thread, everything the game prints goes through the renderer. With
+        // -events the board and messages are dropped, errors still go to
+        // stderr, and the event stream is the output.
+        std::unique_ptr<Renderer> renderer;
+        std::unique_ptr<Game> game;
+        std::ostream discard(nullptr);
+        if (events_mode) {
+            game = std::make_unique<Game>(deck1_file, deck2_file, init_file, testing_mode, graphics_mode,
+                                          discard, std::cerr);
+            game->getEvents().subscribe(std::make_shared<JsonLinesSink>(std::cout));
+        } else if (render_thread) {
+            renderer = std::make_unique<Renderer>(std::cout);
+            game = std::make_unique<Game>(deck1_file, deck2_file, init_file, testing_mode, graphics_mode,
+                                          renderer->text(), renderer->text());
+            game->setRenderer(renderer.get());
+        } else {
+            game = std::make_unique<Game>(deck1_file, deck2_file, init_file, testing_mode, graphics_mode);
+        }
+        if (seeded) game->seed(seed);
+        if (quiet) game->getOutput().setLevel(OutputLevel::Info);
+        game->setFastForward(fast_forward);
+        if (bot_player == 1 || bot_player == 2) {
+            bot = std::make_unique<AnytimeBot>(think_ms / 1000);
+            bot->setPondering(ponder);
+            game->setBot(bot_player, bot.get());
+        }
+        std::ofstream event_log_file;
+        if (!event_log.empty()) {
+            event_log_file.open(event_log);
+            if (!event_log_file) throw std::runtime_error("Could not open event log " + event_log);
+            game->getEvents().subscribe(std::make_shared<JsonLinesSink>(event_log_file));
+        }
+        // A resumed game skips the player names and picks up at its next command
+        if (!autosave_file.empty()) game->setAutosave(autosave_file);
+        if (!resume_file.empty()) game->load(resume_file);
         
         // Run the game
+        // The 'cin.exceptions(ios::eofbit)' line is crucial for handling Ctrl-D (EOF)
+        // as an exception, which allows the program to terminate gracefully when input
+        // is redirected from a file that ends, or when the user signals EOF.
+        std::cin.exceptions(std::ios::eofbit);
         game->run();
 
     } catch (const std::ios::failure &e) {
@@ -0,0 +1,144 @@
+#include "memstats.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <malloc.h>
+
+namespace {
+
+constexpr int CATEGORIES = static_cast<int>(MemCategory::Count);
+
+// Threads count into slots of their own, so counting never contends. This
+// runs inside operator new, so it can't allocate: the slots are a fixed
+// array, and threads past the last share it.
+constexpr unsigned SLOTS = 64;
+
+struct alignas(64) Slot {
+    std::atomic<std::uint64_t> allocations[CATEGORIES] = {};
+    std::atomic<std::uint64_t> bytes[CATEGORIES] = {};
+    std::atomic<std::int64_t> live{0};
+};
+
+Slot slots[SLOTS];
+std::atomic<unsigned> next_slot{0};
+
+thread_local Slot* slot = nullptr;
+thread_local MemCategory current = MemCategory::Other;
+thread_local MemCounts* game = nullptr;
+
+Slot& local() {
+    if (!slot) slot = &slots[std::min(next_slot++, SLOTS - 1)];
+    return *slot;
+}
+
+[[maybe_unused]] void count(void* p, std::size_t size) {
+    Slot& s = local();
+    int c = static_cast<int>(current);
+    s.allocations[c].fetch_add(1, std::memory_order_relaxed);
+    s.bytes[c].fetch_add(size, std::memory_order_relaxed);
+    s.live.fetch_add(malloc_usable_size(p), std::memory_order_relaxed);
+    if (game) {
+        ++game->allocations[c];
+        game->bytes[c] += size;
+    }
+}
+
+[[maybe_unused]] void uncount(void* p) { local().live.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed); }
+
+const char* categoryName(int c) {
+    static const char* const NAMES[] = {"other", "cards", "enchantments", "render", "commands", "spells"};
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == CATEGORIES, "Every category needs a name");
+    return NAMES[c];
+}
+
+} // namespace
+
+#if SORCERY_MEMSTATS
+
+void* operator new(std::size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    count(p, size);
+    return p;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    uncount(p);
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete(p); }
+
+#endif
+
+MemCounts& MemCounts::operator+=(const MemCounts& other) {
+    for (int c = 0; c < CATEGORIES; ++c) {
+        allocations[c] += other.allocations[c];
+        bytes[c] += other.bytes[c];
+    }
+    return *this;
+}
+
+MemCounts MemCounts::operator-(const MemCounts& other) const {
+    MemCounts diff = *this;
+    for (int c = 0; c < CATEGORIES; ++c) {
+        diff.allocations[c] -= other.allocations[c];
+        diff.bytes[c] -= other.bytes[c];
+    }
+    return diff;
+}
+
+namespace memstats {
+
+MemCounts process() {
+    MemCounts counts;
+    for (const Slot& s : slots) {
+        for (int c = 0; c < CATEGORIES; ++c) {
+            counts.allocations[c] += s.allocations[c].load(std::memory_order_relaxed);
+            counts.bytes[c] += s.bytes[c].load(std::memory_order_relaxed);
+        }
+    }
+    return counts;
+}
+
+std::int64_t live() {
+    std::int64_t total = 0;
+    for (const Slot& s : slots) total += s.live.load(std::memory_order_relaxed);
+    return total;
+}
+
+void report(std::ostream& out, const MemCounts& counts) {
+    if (!SORCERY_MEMSTATS) {
+        out << "Allocation accounting is not compiled in (build with make -B MEMSTATS=1)." << std::endl;
+        return;
+    }
+    std::uint64_t allocations = 0, bytes = 0;
+    for (int c = 0; c < CATEGORIES; ++c) {
+        allocations += counts.allocations[c];
+        bytes += counts.bytes[c];
+    }
+    out << std::left << std::setw(14) << "category" << std::right << std::setw(12) << "allocs" << std::setw(14)
+        << "bytes" << std::endl;
+    for (int c = 0; c < CATEGORIES; ++c) {
+        if (!counts.allocations[c]) continue;
+        out << std::left << std::setw(14) << categoryName(c) << std::right << std::setw(12) << counts.allocations[c]
+            << std::setw(14) << counts.bytes[c] << std::endl;
+    }
+    out << std::left << std::setw(14) << "total" << std::right << std::setw(12) << allocations << std::setw(14)
+        << bytes << std::endl;
+}
+
+Scope::Scope(MemCategory category) : saved(current) { current = category; }
+Scope::~Scope() { current = saved; }
+
+GameScope::GameScope(MemCounts& counts) : saved(game) { game = &counts; }
+GameScope::~GameScope() { game = saved; }
+
+} // namespace memstats
@@ -0,0 +1,81 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <cstdint>
+#include <ostream>
+
+// --- Allocation accounting ---
+// Counts heap allocations and the bytes asked for, by what they were for.
+// Built with SORCERY_MEMSTATS=1 ('make -B MEMSTATS=1'), the engine replaces
+// the global operator new and delete with counting versions; otherwise none
+// of this costs anything and the counts stay at zero.
+//
+// An allocation is charged to the innermost category in scope on its thread,
+// and to the game whose loop is running there, if any.
+#ifndef SORCERY_MEMSTATS
+#define SORCERY_MEMSTATS 0
+#endif
+
+enum class MemCategory : std::uint8_t {
+    Other,
+    Cards,        // CardFactory::createCard for minions, spells and rituals
+    Enchantments, // CardFactory::createCard for enchantments, which wrap minions in play
+    Render,       // card_template_t buffers and the rows built from them
+    Commands,     // Game::step not claimed above: mostly the stringstream a line is parsed with
+    Spells,       // Running a spell's effect
+    Count
+};
+
+struct MemCounts {
+    std::uint64_t allocations[static_cast<int>(MemCategory::Count)] = {};
+    std::uint64_t bytes[static_cast<int>(MemCategory::Count)] = {};
+
+    MemCounts& operator+=(const MemCounts& other);
+    MemCounts operator-(const MemCounts& other) const;
+};
+
+namespace memstats {
+
+// Everything allocated so far, over all threads
+MemCounts process();
+// Heap bytes allocated and not yet freed, over all threads
+std::int64_t live();
+
+// Prints allocations and bytes per category, and their totals
+void report(std::ostream& out, const MemCounts& counts);
+
+// Charges allocations on this thread to a category while in scope
+class Scope {
+    MemCategory saved;
+
+public:
+    explicit Scope(MemCategory category);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+// Also adds this thread's allocations to a game's counts while in scope
+class GameScope {
+    MemCounts* saved;
+
+public:
+    explicit GameScope(MemCounts& counts);
+    ~GameScope();
+    GameScope(const GameScope&) = delete;
+    GameScope& operator=(const GameScope&) = delete;
+};
+
+} // namespace memstats
+
+#define MEMSTATS_CONCAT_(a, b) a##b
+#define MEMSTATS_CONCAT(a, b) MEMSTATS_CONCAT_(a, b)
+#if SORCERY_MEMSTATS
+#define MEM_CATEGORY(category) memstats::Scope MEMSTATS_CONCAT(mem_scope_, __LINE__)(category)
+#define MEM_GAME(counts) memstats::GameScope MEMSTATS_CONCAT(mem_game_, __LINE__)(counts)
+#else
+#define MEM_CATEGORY(category) ((void)0)
+#define MEM_GAME(counts) ((void)0)
+#endif
+
+#endif
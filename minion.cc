@@ -3,6 +3,9 @@
 #include "game.h"
 #include "ability.h"
 #include "enchantment.h"
+#include "events.h"
+#include "profile.h"
+#include "trace.h"
 #include <iostream>
 
 Minion::Minion(const std::string& name, int cost, Player* owner, int attack, int defense, 
@@ -11,6 +14,12 @@ Minion::Minion(const std::string& name, int cost, Player* owner, int attack, int
       attackVal(attack), defenseVal(defense), actions(0), ability(ability), 
       triggerType(triggerType), triggerDesc(triggerDesc), component(nullptr) {}
 
+Minion::Minion(const CardDef& def, Player* owner, std::shared_ptr<Ability> ability)
+    : Minion(def.name, def.cost, owner, def.attack, def.defense, ability,
+             def.trigger, def.trigger != TriggerType::None ? def.desc : "") {
+    this->id = def.id;
+}
+
 // --- Getters (can be decorated) ---
 int Minion::getAttack() const { return attackVal; }
 int Minion::getDefense() const { return defenseVal; }
@@ -18,9 +27,28 @@ int Minion::getActions() const { return actions; }
 std::shared_ptr<Ability> Minion::getAbility() const { return ability; }
 int Minion::getAbilityCost() const { return ability ? ability->getCost() : 0; }
 
+void Minion::emit(EventType type, int value, int value2, int target, int target_slot) const {
+    EventBus& events = owner->getGame()->getEvents();
+    if (events.empty()) return;
+    Event event{type, owner->getPlayerId(), owner->findMinion(this), getBaseId(), value, target, target_slot};
+    event.value2 = value2;
+    events.emit(event);
+}
+
 // --- Setters ---
+void Minion::setAttack(int new_attack) { attackVal = new_attack; }
 void Minion::setDefense(int new_defense) { defenseVal = new_defense; }
-void Minion::takeDamage(int amount) { defenseVal -= amount; }
+void Minion::setActions(int new_actions) { actions = new_actions; }
+void Minion::takeDamage(int amount) {
+    defenseVal -= amount;
+    emit(EventType::Damage, amount);
+}
+
+void Minion::buff(int attack, int defense) {
+    attackVal += attack;
+    defenseVal += defense;
+    emit(EventType::Buff, attack, defense);
+}
 void Minion::gainActions(int amount) { actions = std::max(actions, amount); }
 
 void Minion::spendAction() {
@@ -29,13 +57,20 @@ void Minion::spendAction() {
 }
 
 // --- Core game actions ---
+// Playing a minion puts it in the first free slot on the player's board
+void Minion::play(Player* p) { p->addMinion(shared_from_this()); }
+
 void Minion::attack(Player* target) {
+    PROFILE_PHASE(Phase::Attack);
     spendAction();
+    emit(EventType::Attack, 0, 0, target->getPlayerId());
     target->setLife(target->getLife() - getAttack());
 }
 
 void Minion::attack(Minion* target) {
+    PROFILE_PHASE(Phase::Attack);
     spendAction();
+    emit(EventType::Attack, 0, 0, target->getOwner()->getPlayerId(), target->getOwner()->findMinion(target));
     target->takeDamage(getAttack());
     this->takeDamage(target->getAttack());
 }
@@ -47,7 +82,8 @@ void Minion::useAbility(Player* p) {
     int oldMagic = p->getMagic();
     try {
         p->spendMagic(getAbilityCost());
-        getAbility()->apply(p, nullptr, -1);
+        emit(EventType::Ability);
+        getAbility()->apply(p, nullptr, -1, p->findMinion(this));
     } catch (...) {
         if (p->getMagic() < oldMagic) {
             p->gainMagic(oldMagic - p->getMagic());
@@ -62,7 +98,8 @@ void Minion::useAbility(Player* p, Player* t, int i) {
     int oldMagic = p->getMagic();
     try {
         p->spendMagic(getAbilityCost());
-        getAbility()->apply(p, t, i);
+        emit(EventType::Ability, 0, 0, t->getPlayerId(), i);
+        getAbility()->apply(p, t, i, p->findMinion(this));
     } catch (...) {
         if (p->getMagic() < oldMagic) {
             p->gainMagic(oldMagic - p->getMagic());
@@ -73,24 +110,15 @@ void Minion::useAbility(Player* p, Player* t, int i) {
 
 void Minion::useTrigger(TriggerType type, std::shared_ptr<Minion> target) {
     if (this->triggerType == type && getAbility()) {
-        std::cout << getOwner()->getName() << "'s " << name << " trigger activated." << std::endl;
+        trace::Span span("trigger", {getOwner()->getPlayerId(), getOwner()->findMinion(this), getBaseId()});
+        getOwner()->getGame()->getOutput().detail() << getOwner()->getName() << "'s " << name << " trigger activated.\n";
+        emit(EventType::Trigger);
         // Note: Triggers don't cost actions or magic
         // The target of the trigger is the minion that caused the event
         Player* target_owner = target ? target->getOwner() : nullptr; // <-- FIXED
-        
-        // Find target minion's index on its owner's board
-        int target_idx = -1;
-        if(target_owner) {
-            const auto& minions = target_owner->getMinions();
-            for(size_t i = 0; i < minions.size(); ++i) {
-                if (minions[i] == target) {
-                    target_idx = i;
-                    break;
-                }
-            }
-        }
-        
-        getAbility()->apply(getOwner(), target_owner, target_idx);
+        int target_idx = target_owner ? target_owner->findMinion(target.get()) : -1;
+
+        getAbility()->apply(getOwner(), target_owner, target_idx, getOwner()->findMinion(this));
     }
 }
 
@@ -125,19 +153,28 @@ void Minion::stripEnchantments() {
 bool Minion::isDead() const { return getDefense() <= 0; }
 
 // --- Rendering ---
-card_template_t Minion::render() const {
-    if (component) return component->render();
-    return renderBase();
+CardFace Minion::face() const {
+    if (component) return component->face();
+    return faceBase();
 }
 
-card_template_t Minion::renderBase() const {
+CardId Minion::getBaseId() const { return id; }
+
+CardFace Minion::faceBase() const {
+    CardFace f;
+    f.name = name;
+    f.cost = cost;
+    f.attack = attackVal;
+    f.defense = defenseVal;
     if (ability && ability->getCost() > 0) {
-        return display_minion_activated_ability(name, cost, attackVal, defenseVal, ability->getCost(), ability->getDescription());
+        f.layout = CardFace::Layout::ActivatedMinion;
+        f.abilityCost = ability->getCost();
+        f.desc = ability->getDescription();
     } else if (triggerType != TriggerType::None) {
-        return display_minion_triggered_ability(name, cost, attackVal, defenseVal, triggerDesc);
-    } else {
-        return display_minion_no_ability(name, cost, attackVal, defenseVal);
+        f.layout = CardFace::Layout::TriggeredMinion;
+        f.desc = triggerDesc;
     }
+    return f;
 }
 
 std::vector<std::shared_ptr<Enchantment>> Minion::getEnchantments() const {
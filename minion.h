@@ -2,11 +2,12 @@
 #define MINION_H
 
 #include "card.h"
+#include "ability.h"
 #include <vector>
 #include <memory> // Required for std::enable_shared_from_this
 
-class Ability;
 class Enchantment;
+enum class EventType : std::uint8_t;
 
 // Minion class, inherits from Card. This is the "Component" in the Decorator pattern.
 // It now also inherits from std::enable_shared_from_this to allow safe creation of shared_ptrs from 'this'.
@@ -22,10 +23,14 @@ protected:
     // The core of the Decorator pattern: a pointer to the enchantment wrapping this minion
     std::shared_ptr<Minion> component; 
 
+    // Reports an event about this minion to the game's event bus (see events.h)
+    void emit(EventType type, int value = 0, int value2 = 0, int target = 0, int target_slot = -1) const;
+
 public:
     Minion(const std::string& name, int cost, Player* owner, int attack, int defense, 
            std::shared_ptr<Ability> ability = nullptr, 
            TriggerType triggerType = TriggerType::None, const std::string& triggerDesc = "");
+    Minion(const CardDef& def, Player* owner, std::shared_ptr<Ability> ability);
 
     // Getters that can be decorated
     virtual int getAttack() const;
@@ -35,11 +40,16 @@ public:
     virtual std::shared_ptr<Ability> getAbility() const;
 
     // Setters
+    void setAttack(int new_attack);
     void setDefense(int new_defense);
+    void setActions(int new_actions);
     void takeDamage(int amount);
+    void buff(int attack, int defense);
     void gainActions(int amount);
     void spendAction();
 
+    void play(Player* p) override;
+
     // Core game actions (no longer collides with member variable)
     void attack(Player* target);
     void attack(Minion* target);
@@ -56,9 +66,27 @@ public:
     bool isDead() const;
 
     // Rendering methods
-    card_template_t render() const override;
-    virtual card_template_t renderBase() const;
+    CardFace face() const override;
+    virtual CardFace faceBase() const; // The minion under its enchantments
+    virtual CardId getBaseId() const;  // Likewise, its card
     virtual std::vector<std::shared_ptr<Enchantment>> getEnchantments() const;
 };
 
+// A minion from CARD_TABLE. Its definition is looked up and checked at compile
+// time and its ability built once for every copy; its stats start from the
+// definition at runtime, since damage, buffs and enchantments change them.
+template <CardId Id>
+class CardMinion final : public Minion {
+    static constexpr const CardDef& def = cardDef(Id);
+    static_assert(def.type == CardType::Minion, "Card is not a minion");
+public:
+    explicit CardMinion(Player* owner) : Minion(def, owner, ability()) {}
+
+    // Abilities are immutable, so every copy of the card shares one
+    static const std::shared_ptr<Ability>& ability() {
+        static const std::shared_ptr<Ability> shared = makeAbility(def);
+        return shared;
+    }
+};
+
 #endif
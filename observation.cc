@@ -0,0 +1,72 @@
+#include "observation.h"
+#include "game.h"
+
+namespace {
+
+template <typename T>
+T cardValue(CardId id) {
+    return id == CardId::Invalid ? 0 : static_cast<T>(static_cast<int>(id) + 1);
+}
+
+template <typename T>
+T* encodeMinion(const Minion* minion, T* out) {
+    if (!minion) {
+        for (int i = 0; i < OBS_SLOT_SIZE; ++i) *out++ = 0;
+        return out;
+    }
+    *out++ = cardValue<T>(minion->getBaseId());
+    *out++ = minion->getAttack();
+    *out++ = minion->getDefense();
+    *out++ = minion->getActions();
+    *out++ = minion->getAbility() ? minion->getAbilityCost() : 0;
+
+    // Walk the decorator chain top down rather than collecting it with
+    // getEnchantments(), which allocates
+    T* count = out++;
+    int n = 0;
+    const Minion* m = minion;
+    while (auto ench = dynamic_cast<const Enchantment*>(m)) {
+        if (n < OBS_ENCHANTMENTS) out[n] = cardValue<T>(ench->getId());
+        ++n;
+        m = ench->getComponent().get();
+    }
+    *count = n;
+    for (int i = n; i < OBS_ENCHANTMENTS; ++i) out[i] = 0;
+    return out + OBS_ENCHANTMENTS;
+}
+
+template <typename T>
+T* encodeSide(const Player& p, bool showHand, T* out) {
+    const auto& hand = p.getHand();
+    const auto& graveyard = p.getGraveyard();
+    *out++ = p.getLife();
+    *out++ = p.getMagic();
+    *out++ = p.getDeckSize();
+    *out++ = hand.size();
+    *out++ = graveyard.size();
+    *out++ = graveyard.empty() ? 0 : cardValue<T>(graveyard.back()->getBaseId());
+
+    const auto& ritual = p.getRitual();
+    *out++ = ritual ? cardValue<T>(ritual->getId()) : 0;
+    *out++ = ritual ? ritual->getCharges() : 0;
+    *out++ = ritual ? ritual->getActivationCost() : 0;
+
+    for (const auto& minion : p.getMinions()) out = encodeMinion(minion.get(), out);
+
+    for (int i = 0; i < OBS_HAND; ++i) {
+        *out++ = showHand && i < (int)hand.size() ? cardValue<T>(hand[i]->getId()) : 0;
+    }
+    return out;
+}
+
+template <typename T>
+void encode(Game& game, T* out) {
+    *out++ = game.getActivePlayer()->getPlayerId();
+    out = encodeSide(*game.getActivePlayer(), true, out);
+    encodeSide(*game.getNonActivePlayer(), false, out);
+}
+
+} // namespace
+
+void encodeObservation(Game& game, float* out) { encode(game, out); }
+void encodeObservation(Game& game, std::int32_t* out) { encode(game, out); }
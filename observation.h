@@ -0,0 +1,32 @@
+#ifndef OBSERVATION_H
+#define OBSERVATION_H
+
+#include <cstdint>
+
+class Game;
+
+// --- Observation encoding ---
+// A fixed-size numeric view of a position, as seen by the active player, for
+// training agents. Card ids are stored as id + 1 so that 0 means "no card".
+//
+//     [0]                    active player's id (1 or 2)
+//     [1, 1 + SIDE)          the active player's side
+//     [1 + SIDE, 1 + 2*SIDE) the opponent's side, with their hand hidden
+//
+// Each side is life, magic, deck size, hand size, graveyard size, graveyard
+// top, ritual (card, charges, activation cost), then per board slot the
+// minion's card, attack, defense, actions, ability cost, number of
+// enchantments and the top OBS_ENCHANTMENTS enchantments' cards, and last the
+// cards in hand.
+constexpr int OBS_HAND = 5;
+constexpr int OBS_SLOTS = 5;
+constexpr int OBS_ENCHANTMENTS = 3;
+constexpr int OBS_SLOT_SIZE = 6 + OBS_ENCHANTMENTS;
+constexpr int OBS_SIDE_SIZE = 6 + 3 + OBS_SLOTS * OBS_SLOT_SIZE + OBS_HAND;
+constexpr int OBSERVATION_SIZE = 1 + 2 * OBS_SIDE_SIZE;
+
+// Writes OBSERVATION_SIZE values to out. Allocates nothing.
+void encodeObservation(Game& game, float* out);
+void encodeObservation(Game& game, std::int32_t* out);
+
+#endif
@@ -0,0 +1,20 @@
+#include "output.h"
+
+GameOutput::GameOutput(std::ostream& out, std::ostream& err)
+    : out(out.rdbuf() ? &out : nullptr), err(err.rdbuf() ? &err : nullptr) {}
+
+void GameOutput::setLevel(OutputLevel l) { level = l; }
+OutputLevel GameOutput::getLevel() const { return level; }
+
+std::ostream& GameOutput::at(OutputLevel l) {
+    if (!wants(l)) return none;
+    if (l != OutputLevel::Error) return *out;
+    // Whatever was said before the error comes out first
+    if (out && out != err) out->flush();
+    return *err;
+}
+
+void GameOutput::flush() {
+    if (out) out->flush();
+    if (err && err != out) err->flush();
+}
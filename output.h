@@ -0,0 +1,61 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <cstdint>
+#include <ostream>
+
+// How much a message matters. A game writes the messages at or above its
+// level and drops the rest.
+enum class OutputLevel : std::uint8_t {
+    Detail, // Running commentary: triggers firing, summons cut short
+    Info,   // The board, prompts, replies to commands and the winner
+    Error,  // Failed commands; written to the error stream
+    Off     // As a level: write nothing
+};
+
+// --- GameOutput ---
+// Where a game's text goes. Lines end in '\n' rather than std::endl, and the
+// game flushes once per batch (see Batch) instead of once per line, which
+// matters when a game prints a few dozen lines a command. Errors flush what
+// came before them, so the two streams still interleave in order.
+//
+// A stream with no buffer, like std::ostream(nullptr), counts as nobody
+// listening, so a headless game neither formats nor locks anything.
+// Expensive output should check wants() before building anything; plain
+// messages can be streamed to at(), which hands back a stream that ignores
+// them when they aren't wanted.
+class GameOutput {
+    std::ostream* out;
+    std::ostream* err;
+    OutputLevel level = OutputLevel::Detail;
+    std::ostream none{nullptr}; // Takes the messages nobody wants
+
+public:
+    GameOutput(std::ostream& out, std::ostream& err);
+    GameOutput(const GameOutput&) = delete;
+    GameOutput& operator=(const GameOutput&) = delete;
+
+    void setLevel(OutputLevel level);
+    OutputLevel getLevel() const;
+
+    bool wants(OutputLevel l) const { return l >= level && l != OutputLevel::Off && (l == OutputLevel::Error ? err : out); }
+    std::ostream& at(OutputLevel l);
+    std::ostream& detail() { return at(OutputLevel::Detail); }
+    std::ostream& info() { return at(OutputLevel::Info); }
+    std::ostream& error() { return at(OutputLevel::Error); }
+
+    void flush();
+
+    // Flushes when it goes out of scope, however that happens
+    class Batch {
+        GameOutput& output;
+
+    public:
+        explicit Batch(GameOutput& output) : output(output) {}
+        ~Batch() { output.flush(); }
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+    };
+};
+
+#endif
@@ -0,0 +1,364 @@
+#include "packed.h"
+#include "game.h"
+#include "carddb.h"
+#include "cardfactory.h"
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Data bits per group of a variable-length field
+constexpr int VARINT_GROUP = 3;
+
+std::runtime_error tooBig() { return std::runtime_error("Position does not fit the packed format."); }
+std::runtime_error corrupt() { return std::runtime_error("Corrupt packed position."); }
+
+class BitWriter {
+    PackedState& state;
+    std::uint64_t bits = 0; // Not yet written, lowest first
+    int pending = 0;
+
+public:
+    explicit BitWriter(PackedState& state) : state(state) {}
+
+    void put(long value, int width) {
+        if (value < 0 || value >= (1L << width)) throw tooBig();
+        bits |= static_cast<std::uint64_t>(value) << pending;
+        pending += width;
+        while (pending >= 8) {
+            state.bytes.push_back(bits & 0xFF);
+            bits >>= 8;
+            pending -= 8;
+        }
+    }
+
+    // VARINT_GROUP bits at a time, lowest first, each followed by a bit
+    // saying whether more follow
+    void putCount(long value) {
+        if (value < 0) throw tooBig();
+        for (;;) {
+            put(value & ((1 << VARINT_GROUP) - 1), VARINT_GROUP);
+            value >>= VARINT_GROUP;
+            put(value != 0, 1);
+            if (!value) return;
+        }
+    }
+
+    // Zigzag coded, so small values of either sign stay short
+    void putSigned(long value) {
+        putCount(value < 0 ? (-(value + 1) << 1) | 1 : value << 1);
+    }
+
+    void finish() {
+        if (pending > 0) put(0, 8 - pending);
+    }
+};
+
+class BitReader {
+    const PackedState& state;
+    std::size_t next = 0; // Next byte to load
+    std::uint64_t bits = 0;
+    int pending = 0;
+
+public:
+    explicit BitReader(const PackedState& state) : state(state) {}
+
+    int get(int width) {
+        while (pending < width) {
+            if (next >= state.bytes.size()) throw corrupt();
+            bits |= static_cast<std::uint64_t>(state.bytes[next++]) << pending;
+            pending += 8;
+        }
+        int value = bits & ((1u << width) - 1);
+        bits >>= width;
+        pending -= width;
+        return value;
+    }
+
+    int getCount() {
+        int value = 0;
+        for (int shift = 0;; shift += VARINT_GROUP) {
+            // Past what an int holds, so it can only be garbage
+            if (shift > 27) throw corrupt();
+            value |= get(VARINT_GROUP) << shift;
+            if (!get(1)) return value;
+        }
+    }
+
+    int getSigned() {
+        int value = getCount();
+        return value & 1 ? -(value >> 1) - 1 : value >> 1;
+    }
+
+    // The size of a zone, whose cards take a bit each at the very least
+    std::size_t getLength() {
+        std::size_t length = getCount();
+        if (length > 8 * (state.bytes.size() - next) + pending) throw corrupt();
+        return length;
+    }
+};
+
+int idWidth() {
+    int width = 1;
+    while ((std::size_t{1} << width) < CardDatabase::size()) ++width;
+    return width;
+}
+
+// Stats follow a bit saying whether they differ from a fresh copy of the card
+// (no actions, the card's attack and defense), since most minions off the
+// board are untouched. Qualified calls read the object's own fields rather
+// than decorated values.
+void packStats(const Minion& m, BitWriter& out) {
+    const CardDef& def = CardDatabase::get(m.getId());
+    bool changed = m.Minion::getAttack() != def.attack || m.Minion::getDefense() != def.defense ||
+                   m.Minion::getActions() != 0;
+    out.put(changed, 1);
+    if (changed) {
+        out.putSigned(m.Minion::getAttack());
+        out.putSigned(m.Minion::getDefense());
+        out.putCount(m.Minion::getActions());
+    }
+}
+
+void unpackStats(Minion& m, BitReader& in) {
+    if (!in.get(1)) return;
+    m.setAttack(in.getSigned());
+    m.setDefense(in.getSigned());
+    m.setActions(in.getCount());
+}
+
+bool isPlainMinion(const Card& card) {
+    return card.getType() == CardType::Minion && !dynamic_cast<const Enchantment*>(&card);
+}
+
+// A minion and the enchantments on it. The stats live on the minion at the
+// bottom of the decorator chain, but every object in the chain counts its own
+// actions.
+void packStack(const Minion* top, int w, BitWriter& out) {
+    std::vector<const Enchantment*> chain;
+    const Minion* base = top;
+    while (auto ench = dynamic_cast<const Enchantment*>(base)) {
+        chain.push_back(ench);
+        base = ench->getComponent().get();
+    }
+    out.put(static_cast<int>(base->getId()), w);
+    packStats(*base, out);
+    out.putCount(chain.size());
+    for (const Enchantment* ench : chain) {
+        out.put(static_cast<int>(ench->getId()), w);
+        out.putCount(ench->Minion::getActions());
+    }
+}
+
+void packPlayer(const Player& p, int w, BitWriter& out) {
+    out.putSigned(p.getLife());
+    out.putCount(p.getMagic());
+
+    const auto& deck = p.getDeck();
+    out.putCount(deck.size());
+    for (CardId id : deck) out.put(static_cast<int>(id), w);
+
+    const auto& hand = p.getHand();
+    out.putCount(hand.size());
+    for (const auto& card : hand) {
+        out.put(static_cast<int>(card->getId()), w);
+        if (isPlainMinion(*card)) packStats(static_cast<const Minion&>(*card), out);
+    }
+
+    const auto& graveyard = p.getGraveyard();
+    out.putCount(graveyard.size());
+    for (const auto& minion : graveyard) packStack(minion.get(), w, out);
+
+    const auto& ritual = p.getRitual();
+    out.put(ritual != nullptr, 1);
+    if (ritual) {
+        out.put(static_cast<int>(ritual->getId()), w);
+        out.putCount(ritual->getCharges());
+    }
+
+    const auto& minions = p.getMinions();
+    int mask = 0;
+    for (int i = 0; i < 5; ++i) {
+        if (minions[i]) mask |= 1 << i;
+    }
+    out.put(mask, 5);
+    for (const auto& minion : minions) {
+        if (minion) packStack(minion.get(), w, out);
+    }
+}
+
+template <typename T>
+std::shared_ptr<T> readCard(Player& p, int w, BitReader& in) {
+    int id = in.get(w);
+    if (static_cast<std::size_t>(id) >= CardDatabase::size()) throw corrupt();
+    auto card = std::dynamic_pointer_cast<T>(CardFactory::createCard(static_cast<CardId>(id), &p));
+    if (!card) throw corrupt();
+    return card;
+}
+
+std::shared_ptr<Minion> unpackStack(Player& p, int w, BitReader& in) {
+    auto base = readCard<Minion>(p, w, in);
+    if (!isPlainMinion(*base)) throw corrupt();
+    unpackStats(*base, in);
+
+    // Enchantments are stored top first, so build the chain from the top down
+    std::size_t n = in.getLength();
+    std::shared_ptr<Minion> top = base;
+    std::shared_ptr<Enchantment> above;
+    for (std::size_t k = 0; k < n; ++k) {
+        auto ench = readCard<Enchantment>(p, w, in);
+        ench->setActions(in.getCount());
+        if (above) above->setComponent(ench);
+        else top = ench;
+        above = ench;
+    }
+    if (above) above->setComponent(base);
+    return top;
+}
+
+void unpackPlayer(Player& p, int w, BitReader& in) {
+    p.setLife(in.getSigned());
+    p.setMagic(in.getCount());
+
+    auto& deck = p.getDeck();
+    deck.resize(in.getLength());
+    for (CardId& id : deck) {
+        int value = in.get(w);
+        if (static_cast<std::size_t>(value) >= CardDatabase::size()) throw corrupt();
+        id = static_cast<CardId>(value);
+    }
+
+    auto& hand = p.getHand();
+    hand.resize(in.getLength());
+    for (auto& card : hand) {
+        card = readCard<Card>(p, w, in);
+        if (isPlainMinion(*card)) unpackStats(static_cast<Minion&>(*card), in);
+    }
+
+    auto& graveyard = p.getGraveyard();
+    graveyard.resize(in.getLength());
+    for (auto& minion : graveyard) minion = unpackStack(p, w, in);
+
+    std::shared_ptr<Ritual> ritual;
+    if (in.get(1)) {
+        ritual = readCard<Ritual>(p, w, in);
+        ritual->setCharges(in.getCount());
+    }
+    p.setRitual(ritual);
+
+    auto& minions = p.getMinions();
+    int mask = in.get(5);
+    for (int i = 0; i < 5; ++i) {
+        minions[i] = mask & (1 << i) ? unpackStack(p, w, in) : nullptr;
+    }
+}
+
+} // namespace
+
+PackedState packState(Game& game) {
+    PackedState state;
+    packState(game, state);
+    return state;
+}
+
+void packState(Game& game, PackedState& state) {
+    state.bytes.clear();
+    BitWriter out(state);
+    int w = idWidth();
+    out.put(w - 1, 4);
+    out.put(game.getActivePlayer()->getPlayerId() - 1, 1);
+    packPlayer(*game.getPlayer(1), w, out);
+    packPlayer(*game.getPlayer(2), w, out);
+    out.finish();
+}
+
+void unpackState(const PackedState& state, Game& game) {
+    BitReader in(state);
+    int w = in.get(4) + 1;
+    if (w != idWidth()) throw std::runtime_error("Packed position is from a different card database.");
+    game.setActivePlayer(in.get(1) + 1);
+    unpackPlayer(*game.getPlayer(1), w, in);
+    unpackPlayer(*game.getPlayer(2), w, in);
+}
+
+void writePackedState(std::ostream& out, const PackedState& state) {
+    std::string length;
+    putLength(length, state.bytes.size());
+    out.write(length.data(), length.size());
+    out.write(reinterpret_cast<const char*>(state.bytes.data()), state.bytes.size());
+}
+
+void putLength(std::string& out, std::size_t length) {
+    for (; length >= 0x80; length >>= 7) out += static_cast<char>((length & 0x7F) | 0x80);
+    out += static_cast<char>(length);
+}
+
+bool getLength(const std::uint8_t* data, std::size_t size, std::size_t& offset, std::size_t& length) {
+    length = 0;
+    for (int shift = 0; shift < 28; shift += 7) {
+        if (offset >= size) return false;
+        std::uint8_t byte = data[offset++];
+        length |= static_cast<std::size_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return length <= size - offset;
+    }
+    return false;
+}
+
+// --- PackedCorpus ---
+
+PackedCorpus::PackedCorpus(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Could not open corpus " + filename);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not stat corpus " + filename);
+    }
+    length = static_cast<std::size_t>(st.st_size);
+    if (length > 0) {
+        void* map = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Could not map corpus " + filename);
+        }
+        base = static_cast<const std::uint8_t*>(map);
+    }
+    ::close(fd);
+
+    std::size_t offset = 0;
+    while (offset < length) {
+        if (count % STRIDE == 0) index.push_back(offset);
+        std::size_t size;
+        if (!getLength(base, length, offset, size)) {
+            ::munmap(const_cast<std::uint8_t*>(base), length);
+            throw std::runtime_error(filename + ": truncated corpus");
+        }
+        offset += size;
+        ++count;
+    }
+}
+
+PackedCorpus::~PackedCorpus() {
+    if (base) ::munmap(const_cast<std::uint8_t*>(base), length);
+}
+
+std::size_t PackedCorpus::size() const { return count; }
+
+PackedState PackedCorpus::at(std::size_t i) const {
+    if (i >= count) throw std::out_of_range("Corpus position out of range.");
+    // Every length was checked when the file was indexed
+    std::size_t offset = index[i / STRIDE], size;
+    for (std::size_t k = i % STRIDE; k > 0; --k) {
+        getLength(base, length, offset, size);
+        offset += size;
+    }
+
+    PackedState state;
+    getLength(base, length, offset, size);
+    state.bytes.assign(base + offset, base + offset + size);
+    return state;
+}
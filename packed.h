@@ -0,0 +1,82 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class Game;
+
+// --- Packed positions ---
+// A position squeezed into a bit stream, for datasets and endgame tables.
+// Games with the default deck take 30 to 70 bytes a position. Fields are
+// packed least significant bit first, with card ids in the fewest bits that
+// hold every id in the card database (5 for the base set, at most 16).
+// Counts and other numbers with no limit in the rules are variable-length: 3
+// bits at a time, lowest first, each group followed by a bit that is 1 if
+// another follows.
+// Signed ones are zigzag coded first (0, -1, 1, -2, ... as 0, 1, 2, 3, ...).
+//
+//     id width - 1 (4 bits), active player - 1 (1)
+//     then for player 1 and player 2:
+//       life (signed), magic
+//       deck size and ids, bottom first
+//       hand size and ids, minions followed by their stats
+//       graveyard size and minion stacks, bottom first
+//       has ritual (1), then id and charges
+//       occupied board slots (5-bit mask), then a minion stack per minion
+//
+// A minion stack is the minion's id and stats, the number of enchantments on
+// it and per enchantment, top first, its id and actions. Stats are 1 if the
+// minion's attack, defense or actions differ from a fresh copy of the card,
+// then attack (signed), defense (signed) and actions; otherwise 0.
+//
+// An enchanted minion bounced to hand comes back as a fresh copy of its top
+// enchantment, which is all that can be done with it there. Positions only
+// decode against the card database they were encoded with.
+struct PackedState {
+    std::vector<std::uint8_t> bytes;
+};
+
+// Throws if a number is negative where the rules never make it so
+PackedState packState(Game& game);
+// The same into state, reusing its buffer, for callers packing every step
+void packState(Game& game, PackedState& state);
+// Replaces the players' zones, life and magic and the turn in a game that has
+// been set up. Reusing one game for many positions avoids loading decks.
+void unpackState(const PackedState& state, Game& game);
+
+// Appends a position to a corpus file: its length, then its bytes
+void writePackedState(std::ostream& out, const PackedState& state);
+
+// Lengths in files are 7 bits a byte, lowest first, with the top bit set on
+// every byte but the last
+void putLength(std::string& out, std::size_t length);
+// Reads a length at offset, moving past it. False if it is cut off or runs
+// past size.
+bool getLength(const std::uint8_t* data, std::size_t size, std::size_t& offset, std::size_t& length);
+
+// A corpus file mapped read-only into memory. Only every 64th position's
+// offset is indexed, so a corpus of tens of millions of positions costs a few
+// megabytes on top of the pages the kernel keeps cached.
+class PackedCorpus {
+    static constexpr std::size_t STRIDE = 64;
+
+    const std::uint8_t* base = nullptr;
+    std::size_t length = 0;
+    std::size_t count = 0;
+    std::vector<std::size_t> index; // Offset of positions 0, STRIDE, 2*STRIDE, ...
+
+public:
+    explicit PackedCorpus(const std::string& filename);
+    ~PackedCorpus();
+    PackedCorpus(const PackedCorpus&) = delete;
+    PackedCorpus& operator=(const PackedCorpus&) = delete;
+
+    std::size_t size() const;
+    PackedState at(std::size_t i) const;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// --- Parallel loops ---
+// For batch jobs (perft, corpus runs, tournaments, deck searches) that are a
+// list of independent pieces of work. Hosted games, which come and go, run on
+// the Scheduler instead (see scheduler.h).
+
+// The threads to run count jobs on: as asked, or one per core for 0, but
+// never more than there are jobs
+inline unsigned threadCount(unsigned threads, std::size_t count) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(count, 1)));
+}
+
+// Calls body(worker, i) for every i below count, on threadCount(threads,
+// count) threads taking the next i as they finish the last. The calling
+// thread is worker 0 and the rest are numbered from 1, so per-thread state
+// can be kept in a vector indexed by worker. Returns once every call has.
+template <typename Body>
+void parallelFor(std::size_t count, unsigned threads, Body body) {
+    std::atomic<std::size_t> next{0};
+    auto worker = [&](unsigned w) {
+        for (std::size_t i; (i = next++) < count;) body(w, i);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threadCount(threads, count); ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& t : pool) t.join();
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "perft.h"
+#include "actions.h"
+#include "game.h"
+#include "packed.h"
+#include "parallel.h"
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+namespace {
+
+// Runs an action on the position the scratch game holds. Returns false if it
+// is illegal, leaving the scratch game to be unpacked again.
+bool tryAction(Game& work, int action) {
+    try {
+        applyAction(work, action);
+        work.removeDeadMinions();
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::uint64_t count(Game& work, const PackedState& position, int depth) {
+    unpackState(position, work);
+    int moves[ACTION_COUNT];
+    int n = candidateActions(work, moves);
+    std::uint64_t nodes = 0;
+    bool unpacked = true; // The scratch game still holds this position
+    for (int k = 0; k < n; ++k) {
+        if (!unpacked) unpackState(position, work);
+        unpacked = false;
+        if (!tryAction(work, moves[k])) continue;
+        if (depth == 1) {
+            ++nodes;
+        } else if (!work.getWinner()) {
+            nodes += count(work, packState(work), depth - 1);
+        }
+    }
+    return nodes;
+}
+
+} // namespace
+
+PerftResult perft(Game& game, int depth, unsigned threads) {
+    auto start = std::chrono::steady_clock::now();
+    PerftResult result;
+    if (depth < 1) {
+        result.nodes = 1;
+        return result;
+    }
+
+    // The legal first actions and the positions they lead to
+    ScratchGame first;
+    Game& work = first.get(game.isTestingMode());
+    PackedState root = packState(game);
+    std::vector<PackedState> children;
+    std::vector<bool> over;
+    int moves[ACTION_COUNT];
+    int n = candidateActions(game, moves);
+    for (int k = 0; k < n; ++k) {
+        unpackState(root, work);
+        if (!tryAction(work, moves[k])) continue;
+        result.divide.emplace_back(moves[k], 1);
+        children.push_back(packState(work));
+        over.push_back(work.getWinner() != 0);
+    }
+
+    if (depth > 1) {
+        std::vector<ScratchGame> scratch(threadCount(threads, children.size()));
+        parallelFor(children.size(), threads, [&](unsigned worker, std::size_t i) {
+            Game& mine = scratch[worker].get(game.isTestingMode());
+            result.divide[i].second = over[i] ? 0 : count(mine, children[i], depth - 1);
+        });
+    }
+
+    for (const auto& [action, nodes] : result.divide) result.nodes += nodes;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
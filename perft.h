@@ -0,0 +1,27 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Game;
+
+// --- Perft ---
+// Counts the move sequences of exactly depth legal actions (see actions.h)
+// from a position, "end" included, the way chess engines check their move
+// generators and measure their speed. A sequence that wins the game early
+// ends there and isn't counted. Positions are copied by packing them (see
+// packed.h), as in the solver, so the counts are a stable measure of the
+// whole rules engine: generating, trying, packing and unpacking moves.
+struct PerftResult {
+    std::uint64_t nodes = 0; // Sequences counted
+    double seconds = 0;
+    std::vector<std::pair<int, std::uint64_t>> divide; // Count under each legal first action
+};
+
+// The first actions are shared out between threads, each with a scratch game
+// of its own; 0 threads is one per core. The game is left as it was.
+PerftResult perft(Game& game, int depth, unsigned threads = 1);
+
+#endif
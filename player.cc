@@ -6,11 +6,30 @@
 #include "spell.h"
 #include "enchantment.h"
 #include "cardfactory.h"
+#include "carddb.h"
+#include "profile.h"
+#include "trace.h"
 #include <fstream>
 #include <iostream>
 #include <algorithm>
-#include <random>
-#include <chrono>
+
+namespace {
+
+// A card name a line; blank lines are skipped
+std::vector<CardId> readCards(std::istream& in) {
+    std::vector<CardId> cards;
+    std::string card_name;
+    while (std::getline(in, card_name)) {
+        if (!card_name.empty()) {
+            CardId card = CardDatabase::find(card_name);
+            if (card == CardId::Invalid) throw std::runtime_error("Unknown card name: " + card_name);
+            cards.push_back(card);
+        }
+    }
+    return cards;
+}
+
+} // namespace
 
 Player::Player(int id, const std::string& name, Game* game)
     : id(id), name(name), life(20), magic(3), game(game) {
@@ -22,76 +41,108 @@ int Player::getPlayerId() const { return id; }
 const std::string& Player::getName() const { return name; }
 int Player::getLife() const { return life; }
 int Player::getMagic() const { return magic; }
+int Player::getDeckSize() const { return deck.size(); }
 Game* Player::getGame() const { return game; }
 const std::vector<std::shared_ptr<Card>>& Player::getHand() const { return hand; }
 std::vector<std::shared_ptr<Card>>& Player::getHand() { return hand; } // Implementation of non-const version
 const std::vector<std::shared_ptr<Minion>>& Player::getMinions() const { return minions; }
 std::vector<std::shared_ptr<Minion>>& Player::getMinions() { return minions; } // Implementation of non-const version
 const std::vector<std::shared_ptr<Minion>>& Player::getGraveyard() const { return graveyard; }
+std::vector<std::shared_ptr<Minion>>& Player::getGraveyard() { return graveyard; }
+const std::vector<CardId>& Player::getDeck() const { return deck; }
+std::vector<CardId>& Player::getDeck() { return deck; }
 std::shared_ptr<Ritual> Player::getRitual() const { return ritual; }
 
+int Player::findMinion(const Minion* minion) const {
+    for (size_t i = 0; i < minions.size(); ++i) {
+        if (minions[i].get() == minion) return i;
+    }
+    return -1;
+}
+
 // --- Setters & Modifiers ---
-void Player::setLife(int new_life) { life = new_life; }
-void Player::gainMagic(int amount) { magic += amount; }
+void Player::setLife(int new_life) {
+    life = new_life;
+    game->getEvents().emit({EventType::Life, id, -1, CardId::Invalid, life});
+}
+
+void Player::gainMagic(int amount) { setMagic(magic + amount); }
 
 void Player::spendMagic(int amount) {
     if (game->isTestingMode()) {
-        if (magic < amount) magic = 0;
-        else magic -= amount;
+        setMagic(magic < amount ? 0 : magic - amount);
         return;
     }
     if (magic < amount) {
         throw std::runtime_error("Not enough magic.");
     }
-    magic -= amount;
+    setMagic(magic - amount);
+}
+
+void Player::setMagic(int new_magic) {
+    magic = new_magic;
+    game->getEvents().emit({EventType::Magic, id, -1, CardId::Invalid, magic});
 }
 
 void Player::loadDeck(const std::string& filename) {
     std::ifstream file(filename);
     if (!file) {
-        std::cerr << "Error: Could not open deck file " << filename << std::endl;
+        game->getOutput().error() << "Error: Could not open deck file " << filename << '\n';
         // Create the default.deck if it's the one that's missing
         if (filename == "default.deck") {
             system("make default.deck");
             file.open(filename); // Try again
             if (!file) {
-                std::cerr << "Fatal: Could not create or open default.deck. Exiting." << std::endl;
+                game->getOutput().error() << "Fatal: Could not create or open default.deck. Exiting.\n";
                 exit(1);
             }
         } else {
             return;
         }
     }
-    std::string card_name;
-    while (std::getline(file, card_name)) {
-        if (!card_name.empty()) {
-            deck.push_back(CardFactory::createCard(card_name, this));
-        }
-    }
+    std::vector<CardId> cards = readCards(file);
+    deck.insert(deck.end(), cards.begin(), cards.end());
+}
+
+std::vector<CardId> Player::readDeck(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file) throw std::runtime_error("Could not open deck file " + filename);
+    return readCards(file);
+}
+
+void Player::reset(const std::vector<CardId>& new_deck) {
+    life = 20;
+    magic = 3;
+    deck = new_deck;
+    hand.clear();
+    std::fill(minions.begin(), minions.end(), nullptr);
+    graveyard.clear();
+    ritual = nullptr;
 }
 
 void Player::shuffleDeck() {
-    unsigned seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::shuffle(deck.begin(), deck.end(), std::default_random_engine(seed));
+    std::shuffle(deck.begin(), deck.end(), game->getRng());
 }
 
 void Player::drawCard() {
     if (deck.empty()) {
-        std::cout << getName() << "'s deck is empty!" << std::endl;
+        game->getOutput().info() << getName() << "'s deck is empty!\n";
         return;
     }
     if (hand.size() >= 5) {
-        std::cout << getName() << "'s hand is full!" << std::endl;
+        game->getOutput().info() << getName() << "'s hand is full!\n";
         return;
     }
-    hand.push_back(deck.back());
+    hand.push_back(CardFactory::createCard(deck.back(), this));
     deck.pop_back();
+    game->getEvents().emit({EventType::Draw, id, -1, hand.back()->getId()});
 }
 
 void Player::discard(int i) {
     if (i < 0 || i >= (int)hand.size()) {
         throw std::runtime_error("Invalid card index to discard.");
     }
+    game->getEvents().emit({EventType::Discard, id, -1, hand[i]->getId()});
     hand.erase(hand.begin() + i);
 }
 
@@ -99,6 +150,7 @@ void Player::addMinion(std::shared_ptr<Minion> minion) {
     for (size_t i = 0; i < minions.size(); ++i) {
         if (!minions[i]) {
             minions[i] = minion;
+            game->getEvents().emit({EventType::Enter, id, (int)i, minion->getBaseId()});
             game->notifyMinionEnters(minion);
             return;
         }
@@ -111,6 +163,7 @@ void Player::setRitual(std::shared_ptr<Ritual> new_ritual) {
 }
 
 void Player::removeRitual() {
+    if (ritual) game->getEvents().emit({EventType::RitualLost, id, RITUAL_SLOT, ritual->getId()});
     ritual = nullptr;
 }
 
@@ -143,6 +196,7 @@ void Player::removeMinion(int i, bool toGraveyard) {
         throw std::runtime_error("Invalid minion to remove.");
     }
     std::shared_ptr<Minion> removed_minion = minions[i];
+    game->getEvents().emit({EventType::Leave, id, i, removed_minion->getBaseId(), toGraveyard});
     
     game->notifyMinionLeaves(removed_minion);
     
@@ -163,20 +217,23 @@ void Player::removeMinion(int i, bool toGraveyard) {
 
 // Play a card without a target (e.g., a ritual or a non-targeted spell)
 void Player::play(int i) {
+    PROFILE_PHASE(Phase::Play);
     if (i < 0 || i >= (int)hand.size()) throw std::runtime_error("Invalid card index.");
     
     std::shared_ptr<Card> card_to_play = hand[i];
+    trace::Span span("play", {id, i, card_to_play->getId()});
 
     // Record current magic to restore in case play fails
     int oldMagic = magic;
     try {
         spendMagic(card_to_play->getCost());
+        game->getEvents().emit({EventType::Play, id, -1, card_to_play->getId()});
 
         // The card's play method will throw if it's an invalid play (e.g. enchantment w/o target)
         card_to_play->play(this);
     } catch (...) {
         // Restore spent magic if any error occurred
-        magic = oldMagic;
+        if (magic != oldMagic) setMagic(oldMagic);
         throw;
     }
     
@@ -187,8 +244,10 @@ void Player::play(int i) {
 
 // Play a card with a target (e.g., an enchantment or a targeted spell)
 void Player::play(int i, int p, int t) {
+    PROFILE_PHASE(Phase::Play);
     if (i < 0 || i >= (int)hand.size()) throw std::runtime_error("Invalid card index.");
     std::shared_ptr<Card> card_to_play = hand[i];
+    trace::Span span("play", {id, i, card_to_play->getId(), p, t});
 
     Player* target_player = game->getPlayer(p);
     if (!target_player) throw std::runtime_error("Invalid target player.");
@@ -196,10 +255,11 @@ void Player::play(int i, int p, int t) {
     int oldMagic = magic;
     try {
         spendMagic(card_to_play->getCost());
+        game->getEvents().emit({EventType::Play, id, -1, card_to_play->getId(), 0, p, t});
 
         card_to_play->play(this, target_player, t);
     } catch (...) {
-        magic = oldMagic;
+        if (magic != oldMagic) setMagic(oldMagic);
         throw;
     }
     
@@ -214,12 +274,16 @@ void Player::play(int i, int p, int t) {
 }
 
 void Player::use(int i) {
+    PROFILE_PHASE(Phase::Ability);
     if (i < 0 || i >= 5 || !minions[i]) throw std::runtime_error("Invalid minion index.");
+    trace::Span span("ability", {id, i, minions[i]->getBaseId()});
     minions[i]->useAbility(this);
 }
 
 void Player::use(int i, int p, int t) {
+    PROFILE_PHASE(Phase::Ability);
     if (i < 0 || i >= 5 || !minions[i]) throw std::runtime_error("Invalid minion index.");
+    trace::Span span("ability", {id, i, minions[i]->getBaseId(), p, t});
     
     Player* target_player = game->getPlayer(p);
     if (!target_player) throw std::runtime_error("Invalid target player.");
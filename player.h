@@ -4,9 +4,11 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <cstdint>
 
 // Forward declarations to avoid circular dependencies
 class Card;
+enum class CardId : std::uint16_t;
 class Minion;
 class Ritual;
 class Game;
@@ -18,7 +20,7 @@ class Player {
     int magic;
     Game* game; // Raw pointer to game, doesn't own it
 
-    std::vector<std::shared_ptr<Card>> deck;
+    std::vector<CardId> deck; // Undrawn cards are only built when drawn
     std::vector<std::shared_ptr<Card>> hand;
     std::vector<std::shared_ptr<Minion>> minions;
     std::vector<std::shared_ptr<Minion>> graveyard;
@@ -32,19 +34,31 @@ public:
     const std::string& getName() const;
     int getLife() const;
     int getMagic() const;
+    int getDeckSize() const;
     Game* getGame() const;
     const std::vector<std::shared_ptr<Card>>& getHand() const; // Const-version for read-only access
     std::vector<std::shared_ptr<Card>>& getHand();             // Non-const version for modification
     const std::vector<std::shared_ptr<Minion>>& getMinions() const; // Const-version for read-only access
     std::vector<std::shared_ptr<Minion>>& getMinions();             // Non-const version for modification
     const std::vector<std::shared_ptr<Minion>>& getGraveyard() const;
+    std::vector<std::shared_ptr<Minion>>& getGraveyard();
+    const std::vector<CardId>& getDeck() const; // The top card is the last
+    std::vector<CardId>& getDeck();
     std::shared_ptr<Ritual> getRitual() const;
+    int findMinion(const Minion* minion) const; // Board slot of a minion, or -1
 
     // Setters & Modifiers
     void setLife(int new_life);
     void gainMagic(int amount);
     void spendMagic(int amount);
+    void setMagic(int new_magic);
     void loadDeck(const std::string& filename);
+    // The cards a deck file lists, top last. Throws if it can't be read or
+    // names an unknown card.
+    static std::vector<CardId> readDeck(const std::string& filename);
+    // Back to the start of a game with a new deck: full life, starting magic
+    // and nothing in hand, on the board or in the graveyard
+    void reset(const std::vector<CardId>& new_deck);
     void shuffleDeck();
     void drawCard();
     void discard(int i);
@@ -0,0 +1,139 @@
+#include "profile.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Log-linear buckets, as in HdrHistogram: values under 16ns get a bucket
+// each, and every power of two above that is split into 16 buckets. Values
+// past 2^40ns (about 18 minutes) land in the last bucket.
+constexpr int SUB_BITS = 4;
+constexpr int SUB = 1 << SUB_BITS;
+constexpr int MAX_EXPONENT = 40;
+constexpr int BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) * SUB;
+
+int bucketOf(std::uint64_t ns) {
+    if (ns < SUB) return static_cast<int>(ns);
+    ns = std::min<std::uint64_t>(ns, (std::uint64_t{1} << (MAX_EXPONENT + 1)) - 1);
+    int exponent = 63 - __builtin_clzll(ns);
+    int sub = static_cast<int>(ns >> (exponent - SUB_BITS)) & (SUB - 1);
+    return (exponent - SUB_BITS + 1) * SUB + sub;
+}
+
+// The middle of a bucket's range
+double bucketValue(int bucket) {
+    if (bucket < SUB) return bucket;
+    int exponent = bucket / SUB + SUB_BITS - 1;
+    double width = static_cast<double>(std::uint64_t{1} << (exponent - SUB_BITS));
+    return (SUB + bucket % SUB) * width + width / 2;
+}
+
+// One thread's samples. Only the owning thread writes, so plain load and
+// store pairs are enough; the atomics let report() read from any thread.
+struct Histograms {
+    std::atomic<std::uint64_t> counts[static_cast<int>(Phase::Count)][BUCKETS] = {};
+    std::atomic<std::uint64_t> total[static_cast<int>(Phase::Count)] = {};
+    std::atomic<std::uint64_t> max[static_cast<int>(Phase::Count)] = {};
+};
+
+void add(std::atomic<std::uint64_t>& a, std::uint64_t n) {
+    a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// Histograms outlive their threads, so samples from finished workers still count
+std::mutex registry_lock;
+std::vector<std::unique_ptr<Histograms>> registry;
+
+Histograms& local() {
+    thread_local Histograms* mine = nullptr;
+    if (!mine) {
+        auto h = std::make_unique<Histograms>();
+        mine = h.get();
+        std::lock_guard<std::mutex> guard(registry_lock);
+        registry.push_back(std::move(h));
+    }
+    return *mine;
+}
+
+const char* phaseName(Phase phase) {
+    switch (phase) {
+        case Phase::Command: return "command";
+        case Phase::Play: return "play";
+        case Phase::Attack: return "attack";
+        case Phase::Ability: return "ability";
+        case Phase::Triggers: return "triggers";
+        case Phase::Render: return "render";
+        case Phase::Output: return "output";
+        case Phase::Think: return "think";
+        default: return "?";
+    }
+}
+
+std::string duration(double ns) {
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(ns < 1000 ? 0 : 1);
+    if (ns < 1e3) s << ns << "ns";
+    else if (ns < 1e6) s << ns / 1e3 << "us";
+    else if (ns < 1e9) s << ns / 1e6 << "ms";
+    else s << ns / 1e9 << "s";
+    return s.str();
+}
+
+} // namespace
+
+namespace profile {
+
+void record(Phase phase, std::uint64_t ns) {
+    Histograms& h = local();
+    int p = static_cast<int>(phase);
+    add(h.counts[p][bucketOf(ns)], 1);
+    add(h.total[p], ns);
+    if (ns > h.max[p].load(std::memory_order_relaxed)) h.max[p].store(ns, std::memory_order_relaxed);
+}
+
+void report(std::ostream& out) {
+    // Bots record their think time in every build, so there may still be
+    // something to show
+    if (!SORCERY_PROFILE) out << "Phase timing is not compiled in (build with make -B PROFILE=1)." << std::endl;
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    bool header = false;
+
+    std::lock_guard<std::mutex> guard(registry_lock);
+    for (int p = 0; p < static_cast<int>(Phase::Count); ++p) {
+        std::vector<std::uint64_t> counts(BUCKETS);
+        std::uint64_t n = 0, total = 0, max = 0;
+        for (const auto& h : registry) {
+            for (int b = 0; b < BUCKETS; ++b) counts[b] += h->counts[p][b].load(std::memory_order_relaxed);
+            total += h->total[p].load(std::memory_order_relaxed);
+            max = std::max(max, h->max[p].load(std::memory_order_relaxed));
+        }
+        for (std::uint64_t c : counts) n += c;
+        if (n == 0) continue;
+
+        if (!header) {
+            out << std::left << std::setw(10) << "phase" << std::right << std::setw(10) << "count" << std::setw(10)
+                << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+                << std::setw(10) << "p99.9" << std::setw(10) << "max" << std::endl;
+            header = true;
+        }
+        out << std::left << std::setw(10) << phaseName(static_cast<Phase>(p)) << std::right << std::setw(10) << n
+            << std::setw(10) << duration(static_cast<double>(total) / n);
+        for (double q : quantiles) {
+            // The smallest bucket holding at least q of the samples
+            std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(q * n + 0.5));
+            std::uint64_t seen = 0;
+            int b = 0;
+            while ((seen += counts[b]) < rank) ++b;
+            out << std::setw(10) << duration(std::min(bucketValue(b), static_cast<double>(max)));
+        }
+        out << std::setw(10) << duration(max) << std::endl;
+    }
+}
+
+} // namespace profile
@@ -0,0 +1,65 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// --- Phase timing ---
+// Scoped timers around the phases of a command, feeding a latency histogram
+// per phase. Timers cost nothing unless the engine is built with
+// SORCERY_PROFILE=1 ('make -B PROFILE=1'), in which case each costs two
+// steady_clock reads and a few relaxed stores. Timings are inclusive, so a
+// play that sets off triggers counts in both Play and Triggers.
+#ifndef SORCERY_PROFILE
+#define SORCERY_PROFILE 0
+#endif
+
+enum class Phase : std::uint8_t {
+    Command,  // Game::step: parsing a line and carrying it out
+    Play,     // Player::play
+    Attack,   // Minion::attack
+    Ability,  // Player::use
+    Triggers, // Game::execute_triggers, once per call
+    Render,   // Board::display, including the write unless a renderer draws it
+    Output,   // Renderer::draw: formatting and writing a batch of frames
+    Think,    // AnytimeBot::choose; recorded in every build, as bots are tuned by it
+    Count
+};
+
+namespace profile {
+
+// Adds a sample. Each thread records into its own histograms, so recording
+// takes no locks.
+void record(Phase phase, std::uint64_t ns);
+
+// Prints count, mean, percentiles and max for each phase with samples, over
+// all threads. The percentiles are accurate to within about 3%.
+void report(std::ostream& out);
+
+class ScopedTimer {
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(Phase phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        record(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+} // namespace profile
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#if SORCERY_PROFILE
+// Times the rest of the enclosing scope as the given phase
+#define PROFILE_PHASE(phase) profile::ScopedTimer PROFILE_CONCAT(profile_timer_, __LINE__)(phase)
+#else
+#define PROFILE_PHASE(phase) ((void)0)
+#endif
+
+#endif
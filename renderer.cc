@@ -0,0 +1,180 @@
+#include "renderer.h"
+#include "ascii_graphics.h"
+#include "profile.h"
+#include "memstats.h"
+#include <algorithm>
+
+namespace {
+
+// Prints cards side-by-side
+void printRow(const std::vector<card_template_t>& cards, std::ostream& out) {
+    if (cards.empty()) return;
+
+    size_t num_lines = cards[0].size();
+    for (size_t i = 0; i < num_lines; ++i) {
+        for (const auto& card : cards) {
+            if (i < card.size()) {
+                out << card[i];
+            }
+        }
+        out << '\n';
+    }
+}
+
+card_template_t drawSlot(const std::optional<CardFace>& face) {
+    return face ? drawFace(*face) : CARD_TEMPLATE_BORDER;
+}
+
+// Ritual, player card and graveyard
+void printPlayerRow(const PlayerView& p, std::ostream& out) {
+    printRow({drawSlot(p.ritual), CARD_TEMPLATE_EMPTY, display_player_card(p.id, p.name, p.life, p.magic),
+              CARD_TEMPLATE_EMPTY, drawSlot(p.graveyardTop)}, out);
+}
+
+void printMinionRow(const PlayerView& p, std::ostream& out) {
+    std::vector<card_template_t> row;
+    for (const auto& minion : p.minions) row.push_back(drawSlot(minion));
+    printRow(row, out);
+}
+
+} // namespace
+
+void drawBoard(const BoardSnapshot& board, std::ostream& out) {
+    MEM_CATEGORY(MemCategory::Render);
+    const std::string border_h = std::string(185, EXTERNAL_BORDER_CHAR_LEFT_RIGHT[0]);
+    out << EXTERNAL_BORDER_CHAR_TOP_LEFT << border_h << EXTERNAL_BORDER_CHAR_TOP_RIGHT << '\n';
+
+    printPlayerRow(board.players[0], out);
+    printMinionRow(board.players[0], out);
+    for (const auto& line : CENTRE_GRAPHIC) {
+        out << line << '\n';
+    }
+    printMinionRow(board.players[1], out);
+    printPlayerRow(board.players[1], out);
+
+    out << EXTERNAL_BORDER_CHAR_BOTTOM_LEFT << border_h << EXTERNAL_BORDER_CHAR_BOTTOM_RIGHT << '\n';
+}
+
+void drawRow(const std::vector<CardFace>& cards, std::ostream& out) {
+    MEM_CATEGORY(MemCategory::Render);
+    std::vector<card_template_t> row;
+    for (const auto& card : cards) row.push_back(drawFace(card));
+    printRow(row, out);
+}
+
+void drawInspect(const InspectView& view, std::ostream& out) {
+    MEM_CATEGORY(MemCategory::Render);
+    printRow({drawFace(view.minion)}, out);
+
+    // Enchantments, 5 per line
+    if (!view.enchantments.empty()) {
+        out << "Enchantments:\n";
+        for (size_t i = 0; i < view.enchantments.size(); i += 5) {
+            size_t end = std::min(i + 5, view.enchantments.size());
+            drawRow(std::vector<CardFace>(view.enchantments.begin() + i, view.enchantments.begin() + end), out);
+        }
+    }
+}
+
+// --- Render thread ---
+
+Renderer::Renderer(std::ostream& terminal)
+    : terminal(terminal), pending(std::make_unique<Frame>()), thread(&Renderer::loop, this) {}
+
+Renderer::~Renderer() {
+    takeText();
+    while (!pending->empty()) {
+        publish();
+        if (!pending->empty()) std::this_thread::yield();
+    }
+    stopping = true;
+    wakeRenderThread();
+    thread.join();
+}
+
+std::ostream& Renderer::text() { return text_stream; }
+
+// Text written since the last item goes first, to keep everything in order
+void Renderer::takeText() {
+    if (text_stream.tellp() <= 0) return;
+    std::ostringstream drained;
+    drained.swap(text_stream);
+    pending->emplace_back(drained.str());
+}
+
+void Renderer::add(Item item) {
+    takeText();
+    pending->push_back(std::move(item));
+}
+
+void Renderer::board(BoardSnapshot snapshot) { add(std::move(snapshot)); }
+void Renderer::row(std::vector<CardFace> cards) { add(std::move(cards)); }
+void Renderer::inspect(InspectView view) { add(std::move(view)); }
+
+void Renderer::publish() {
+    takeText();
+    if (pending->empty()) return;
+    if (!queue.push(pending)) return; // Full: try again next time
+    pending = std::make_unique<Frame>();
+    wakeRenderThread();
+}
+
+void Renderer::wakeRenderThread() {
+    // Pairs with the fence in loop(): either the render thread sees the new
+    // frame before it sleeps, or we see that it is sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        wake.notify_one();
+    }
+}
+
+void Renderer::loop() {
+    std::vector<std::unique_ptr<Frame>> frames;
+    for (;;) {
+        std::unique_ptr<Frame> frame;
+        while (queue.pop(frame)) frames.push_back(std::move(frame));
+        if (!frames.empty()) {
+            draw(frames);
+            frames.clear();
+            continue;
+        }
+        if (stopping) return;
+
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        sleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!queue.empty() || stopping) {
+            sleeping = false;
+            continue;
+        }
+        wake.wait(guard, [this] { return !sleeping; });
+    }
+}
+
+// Draws a batch of frames in one write, skipping all but the newest board
+void Renderer::draw(std::vector<std::unique_ptr<Frame>>& frames) {
+    PROFILE_PHASE(Phase::Output);
+    const BoardSnapshot* newest = nullptr;
+    for (const auto& frame : frames) {
+        for (const auto& item : *frame) {
+            if (auto board = std::get_if<BoardSnapshot>(&item)) newest = board;
+        }
+    }
+
+    std::ostringstream out;
+    for (const auto& frame : frames) {
+        for (const auto& item : *frame) {
+            if (auto text = std::get_if<std::string>(&item)) {
+                out << *text;
+            } else if (auto board = std::get_if<BoardSnapshot>(&item)) {
+                if (board == newest) drawBoard(*board, out);
+            } else if (auto cards = std::get_if<std::vector<CardFace>>(&item)) {
+                drawRow(*cards, out);
+            } else {
+                drawInspect(std::get<InspectView>(item), out);
+            }
+        }
+    }
+    terminal << out.str() << std::flush;
+}
@@ -0,0 +1,94 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "card.h"
+#include "spsc.h"
+
+// --- Snapshots ---
+// Immutable copies of what the board shows, taken on the rules thread (see
+// Board) and drawable on any thread.
+
+struct PlayerView {
+    int id = 0;
+    std::string name;
+    int life = 0;
+    int magic = 0;
+    std::optional<CardFace> ritual;
+    std::optional<CardFace> graveyardTop;
+    std::array<std::optional<CardFace>, 5> minions;
+};
+
+struct BoardSnapshot {
+    PlayerView players[2];
+};
+
+// A minion without its enchantments, followed by the enchantments, top first
+struct InspectView {
+    CardFace minion;
+    std::vector<CardFace> enchantments;
+};
+
+void drawBoard(const BoardSnapshot& board, std::ostream& out);
+void drawRow(const std::vector<CardFace>& cards, std::ostream& out);
+void drawInspect(const InspectView& view, std::ostream& out);
+
+// --- Render thread ---
+// Draws on a thread of its own so the rules thread never waits on the
+// terminal. The rules thread queues snapshots and text (the game's output
+// stream is text()), then publish() hands them over through a lock-free
+// single-producer/single-consumer queue. The render thread draws everything
+// that has arrived since its last frame in one write, and of several board
+// snapshots it only draws the newest. Text and the hand and inspect views are
+// always drawn, in order.
+class Renderer {
+    using Item = std::variant<std::string, BoardSnapshot, std::vector<CardFace>, InspectView>;
+    using Frame = std::vector<Item>;
+
+    std::ostream& terminal;
+
+    // Rules thread side
+    std::ostringstream text_stream;
+    std::unique_ptr<Frame> pending; // Queued but not yet handed over
+
+    SpscQueue<std::unique_ptr<Frame>, 64> queue;
+
+    // The render thread sleeps when the queue is empty
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> stopping{false};
+    std::thread thread;
+
+    void add(Item item);
+    void takeText();
+    void wakeRenderThread();
+    void loop();
+    void draw(std::vector<std::unique_ptr<Frame>>& frames);
+
+public:
+    explicit Renderer(std::ostream& terminal);
+    // Publishes anything left, waits for it to be drawn and stops the thread
+    ~Renderer();
+
+    std::ostream& text();
+    void board(BoardSnapshot snapshot);
+    void row(std::vector<CardFace> cards);
+    void inspect(InspectView view);
+    // Hands everything queued since the last call to the render thread. If the
+    // queue is full it stays pending and goes with the next call.
+    void publish();
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include "ability.h"
 #include "game.h"
 #include "minion.h" // Include full minion definition
+#include "trace.h"
 #include <iostream>
 
 Ritual::Ritual(const std::string& name, int cost, Player* owner, int charges, int activation_cost, 
@@ -10,6 +11,11 @@ Ritual::Ritual(const std::string& name, int cost, Player* owner, int charges, in
     : Card(name, cost, owner, CardType::Ritual), charges(charges), activation_cost(activation_cost),
       ability(ability), triggerType(triggerType), triggerDesc(triggerDesc) {}
 
+Ritual::Ritual(const CardDef& def, Player* owner, std::shared_ptr<Ability> ability)
+    : Ritual(def.name, def.cost, owner, def.charges, def.activationCost, def.trigger, def.desc, ability) {
+    this->id = def.id;
+}
+
 // Playing a ritual places it on the player's board
 void Ritual::play(Player* p) {
     // Find the shared_ptr to this card in the hand to pass to setRitual
@@ -23,17 +29,26 @@ void Ritual::play(Player* p) {
 }
 
 // Render the ritual card
-card_template_t Ritual::render() const {
-    return display_ritual(name, cost, activation_cost, triggerDesc, charges);
+CardFace Ritual::face() const {
+    CardFace f;
+    f.layout = CardFace::Layout::Ritual;
+    f.name = name;
+    f.cost = cost;
+    f.abilityCost = activation_cost;
+    f.desc = triggerDesc;
+    f.charges = charges;
+    return f;
 }
 
 // Check for and use the ritual's triggered ability
 void Ritual::useTrigger(TriggerType type, std::shared_ptr<Minion> target) {
     if (this->triggerType == type && charges >= activation_cost) {
-        std::cout << getOwner()->getName() << "'s " << name << " trigger activated." << std::endl;
+        trace::Span span("trigger", {getOwner()->getPlayerId(), RITUAL_SLOT, id});
+        getOwner()->getGame()->getOutput().detail() << getOwner()->getName() << "'s " << name << " trigger activated.\n";
         charges -= activation_cost;
+        getOwner()->getGame()->getEvents().emit({EventType::Trigger, getOwner()->getPlayerId(), RITUAL_SLOT, id});
         Player* target_owner = target ? target->getOwner() : nullptr; // <-- FIXED
-        int target_idx = -1; // Ritual triggers often don't have specific targets
+        int target_idx = target_owner ? target_owner->findMinion(target.get()) : -1;
         ability->apply(getOwner(), target_owner, target_idx);
     }
 } 
@@ -41,3 +56,7 @@ void Ritual::useTrigger(TriggerType type, std::shared_ptr<Minion> target) {
 void Ritual::gainCharges(int amount) {
     charges += amount;
 }
+
+int Ritual::getCharges() const { return charges; }
+void Ritual::setCharges(int new_charges) { charges = new_charges; }
+int Ritual::getActivationCost() const { return activation_cost; }
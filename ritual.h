@@ -2,9 +2,9 @@
 #define RITUAL_H
 
 #include "card.h"
+#include "ability.h"
 #include "minion.h"
 
-class Ability;
 class Minion;
 
 // Ritual class, inherits from Card
@@ -18,11 +18,32 @@ class Ritual : public Card {
 public:
     Ritual(const std::string& name, int cost, Player* owner, int charges, int activation_cost, 
            TriggerType triggerType, const std::string& triggerDesc, std::shared_ptr<Ability> ability);
+    Ritual(const CardDef& def, Player* owner, std::shared_ptr<Ability> ability);
 
     void play(Player* p) override;
-    card_template_t render() const override;
+    CardFace face() const override;
     void useTrigger(TriggerType type, std::shared_ptr<Minion> target);
     void gainCharges(int amount);
+    int getCharges() const;
+    void setCharges(int new_charges);
+    int getActivationCost() const;
+};
+
+// A ritual from CARD_TABLE. Its definition is looked up and checked at compile
+// time and its ability built once for every copy; its charges start from the
+// definition at runtime, since using the ritual spends them.
+template <CardId Id>
+class CardRitual final : public Ritual {
+    static constexpr const CardDef& def = cardDef(Id);
+    static_assert(def.type == CardType::Ritual, "Card is not a ritual");
+public:
+    explicit CardRitual(Player* owner) : Ritual(def, owner, ability()) {}
+
+    // Abilities are immutable, so every copy of the card shares one
+    static const std::shared_ptr<Ability>& ability() {
+        static const std::shared_ptr<Ability> shared = makeAbility(def);
+        return shared;
+    }
 };
 
 #endif
@@ -0,0 +1,212 @@
+#include "savefile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[4] = {'S', 'R', 'C', 'Y'};
+constexpr std::uint8_t VERSION = 3;
+
+std::uint32_t crc32(const char* data, std::size_t size) {
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<std::uint8_t>(data[i]);
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+void putInt(std::string& out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+class Reader {
+    const std::string& bytes;
+    std::size_t pos = 0;
+
+public:
+    explicit Reader(const std::string& bytes) : bytes(bytes) {}
+
+    const char* take(std::size_t n) {
+        if (bytes.size() - pos < n) throw std::runtime_error("Save file is truncated.");
+        const char* p = bytes.data() + pos;
+        pos += n;
+        return p;
+    }
+
+    std::size_t getLength() {
+        std::size_t length;
+        if (!::getLength(reinterpret_cast<const std::uint8_t*>(bytes.data()), bytes.size(), pos, length)) {
+            throw std::runtime_error("Save file is truncated.");
+        }
+        return length;
+    }
+
+    std::uint64_t getInt(int n) {
+        const char* p = take(n);
+        std::uint64_t value = 0;
+        for (int i = 0; i < n; ++i) value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(p[i])) << (8 * i);
+        return value;
+    }
+};
+
+// Why writing the file failed, from the call that failed, or "" if it didn't
+std::string writeFile(const std::string& path, const std::string& data) {
+    std::string temp = path + ".tmp";
+    int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return std::strerror(errno);
+    std::string failure;
+    for (std::size_t written = 0; written < data.size() && failure.empty();) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n > 0) written += n;
+        else if (n == 0) failure = "short write";
+        else if (errno != EINTR) failure = std::strerror(errno);
+    }
+    if (failure.empty() && ::fsync(fd) != 0) failure = std::strerror(errno);
+    if (::close(fd) != 0 && failure.empty()) failure = std::strerror(errno);
+    if (failure.empty() && std::rename(temp.c_str(), path.c_str()) != 0) failure = std::strerror(errno);
+    if (!failure.empty()) ::unlink(temp.c_str());
+    return failure;
+}
+
+} // namespace
+
+std::string encodeSave(const SaveData& save) {
+    std::string out(MAGIC, sizeof(MAGIC));
+    out += static_cast<char>(VERSION);
+    for (const auto& name : save.names) {
+        if (name.size() > 255) throw std::runtime_error("Player name is too long to save.");
+        out += static_cast<char>(name.size());
+        out += name;
+    }
+    for (std::uint64_t word : save.rng) putInt(out, word, 8);
+    putLength(out, save.position.bytes.size());
+    out.append(save.position.bytes.begin(), save.position.bytes.end());
+    putInt(out, crc32(out.data(), out.size()), 4);
+    return out;
+}
+
+SaveData decodeSave(const std::string& bytes) {
+    if (bytes.size() < sizeof(MAGIC) + 5 || !std::equal(MAGIC, MAGIC + sizeof(MAGIC), bytes.begin())) {
+        throw std::runtime_error("Not a save file.");
+    }
+    std::size_t body = bytes.size() - 4;
+    Reader check(bytes);
+    check.take(body);
+    if (check.getInt(4) != crc32(bytes.data(), body)) throw std::runtime_error("Save file is corrupt.");
+
+    Reader in(bytes);
+    in.take(sizeof(MAGIC));
+    if (in.getInt(1) != VERSION) throw std::runtime_error("Save file is from another version.");
+    SaveData save;
+    for (auto& name : save.names) {
+        std::size_t size = in.getInt(1);
+        name.assign(in.take(size), size);
+    }
+    for (auto& word : save.rng) word = in.getInt(8);
+    std::size_t size = in.getLength();
+    const char* position = in.take(size);
+    save.position.bytes.assign(position, position + size);
+    return save;
+}
+
+SaveData readSaveFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) throw std::runtime_error("Could not open save file " + filename);
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return decodeSave(bytes);
+}
+
+// --- AsyncFileWriter ---
+
+AsyncFileWriter::AsyncFileWriter() : thread(&AsyncFileWriter::loop, this) {}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    thread.join();
+}
+
+AsyncFileWriter& AsyncFileWriter::instance() {
+    static AsyncFileWriter writer;
+    return writer;
+}
+
+std::uint64_t AsyncFileWriter::write(const std::string& path, std::string data) {
+    std::uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        ticket = ++last_ticket;
+        unfinished.insert(ticket);
+        auto [it, added] = pending.try_emplace(path);
+        it->second.data = std::move(data);
+        it->second.tickets.push_back(ticket);
+        if (added) order.push_back(path);
+    }
+    changed.notify_all();
+    return ticket;
+}
+
+void AsyncFileWriter::flush() {
+    std::unique_lock<std::mutex> guard(lock);
+    changed.wait(guard, [this] { return order.empty() && !writing; });
+}
+
+bool AsyncFileWriter::finished(std::uint64_t ticket, std::string& error) {
+    if (unfinished.count(ticket)) return false;
+    auto it = failures.find(ticket);
+    if (it == failures.end()) {
+        error.clear();
+    } else {
+        error = std::move(it->second);
+        failures.erase(it);
+    }
+    return true;
+}
+
+std::string AsyncFileWriter::wait(std::uint64_t ticket) {
+    std::unique_lock<std::mutex> guard(lock);
+    std::string error;
+    changed.wait(guard, [&] { return finished(ticket, error); });
+    return error;
+}
+
+bool AsyncFileWriter::poll(std::uint64_t ticket, std::string& error) {
+    std::lock_guard<std::mutex> guard(lock);
+    return finished(ticket, error);
+}
+
+void AsyncFileWriter::loop() {
+    std::unique_lock<std::mutex> guard(lock);
+    for (;;) {
+        changed.wait(guard, [this] { return !order.empty() || stopping; });
+        if (order.empty()) return; // Stopping, with nothing left to write
+
+        std::string path = std::move(order.front());
+        order.erase(order.begin());
+        Job job = std::move(pending[path]);
+        pending.erase(path);
+        writing = true;
+        guard.unlock();
+
+        std::string failure = writeFile(path, job.data);
+
+        guard.lock();
+        writing = false;
+        for (std::uint64_t ticket : job.tickets) {
+            unfinished.erase(ticket);
+            if (!failure.empty()) failures[ticket] = "Could not save to " + path + ": " + failure;
+        }
+        changed.notify_all();
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef SAVEFILE_H
+#define SAVEFILE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "packed.h"
+#include "rng.h"
+
+// --- Save files ---
+// A saved game, in this order (integers little-endian):
+//
+//     "SRCY", format version (1 byte)
+//     player names, each a length byte and the name
+//     the game's random number generator state (4 x 8 bytes)
+//     the position: its length (see putLength in packed.h), then its bytes
+//     CRC-32 of everything before it (4 bytes)
+//
+// A game in progress is a little over 100 bytes.
+struct SaveData {
+    std::string names[2];
+    Rng::State rng{};
+    PackedState position;
+};
+
+std::string encodeSave(const SaveData& save);
+// Throws if the data is truncated, from another version or fails the checksum
+SaveData decodeSave(const std::string& bytes);
+SaveData readSaveFile(const std::string& filename);
+
+// --- Background writes ---
+// Writes files on a thread of its own, so saving costs the caller no more
+// than encoding. Each file is written to a temporary name and renamed over
+// the old one, so a crash mid-write leaves the last checkpoint intact. If a
+// file is queued again before its last write started, only the newest data
+// is written, and both tickets get that write's outcome.
+//
+// Every write has a ticket, and its outcome goes to whoever holds it, so one
+// game never sees another's failure. A failure is kept until it is taken.
+class AsyncFileWriter {
+    struct Job {
+        std::string data;
+        std::vector<std::uint64_t> tickets; // Every write the data stands for
+    };
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::unordered_map<std::string, Job> pending; // By path
+    std::vector<std::string> order; // Paths in pending, oldest first
+    bool writing = false;
+    bool stopping = false;
+    std::uint64_t last_ticket = 0;
+    std::unordered_set<std::uint64_t> unfinished;
+    std::unordered_map<std::uint64_t, std::string> failures; // Until taken, by ticket
+    std::thread thread;
+
+    void loop();
+    // Whether a ticket's write is done, and if so why it failed ("" if it
+    // didn't), forgetting it. Needs the lock.
+    bool finished(std::uint64_t ticket, std::string& error);
+
+public:
+    AsyncFileWriter();
+    // Writes whatever is still queued, then stops
+    ~AsyncFileWriter();
+
+    // The writer shared by every game in the process
+    static AsyncFileWriter& instance();
+
+    // Returns the write's ticket
+    std::uint64_t write(const std::string& path, std::string data);
+    // Waits until everything queued so far is written
+    void flush();
+    // Waits for a write, then returns why it failed, or "" if it didn't
+    std::string wait(std::uint64_t ticket);
+    // False while the write is still to come; otherwise true, with error as
+    // for wait()
+    bool poll(std::uint64_t ticket, std::string& error);
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "scheduler.h"
+
+Scheduler::Scheduler(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    for (unsigned i = 0; i < threads; ++i) workers.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < threads; ++i) workers[i]->thread = std::thread(&Scheduler::work, this, i);
+}
+
+Scheduler::~Scheduler() {
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker->thread.join();
+}
+
+unsigned Scheduler::size() const { return workers.size(); }
+
+void Scheduler::schedule(std::shared_ptr<Task> task) {
+    if (task->home == Task::NO_HOME) task->home = next_home++ % workers.size();
+    Worker& worker = *workers[task->home];
+    {
+        std::lock_guard<std::mutex> guard(worker.lock);
+        worker.queue.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        ++queued;
+    }
+    wake.notify_one();
+}
+
+// The oldest task from our own queue, or else the newest from someone else's
+std::shared_ptr<Task> Scheduler::take(unsigned self) {
+    std::shared_ptr<Task> task;
+    for (unsigned i = 0; i < workers.size() && !task; ++i) {
+        Worker& worker = *workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> guard(worker.lock);
+        if (worker.queue.empty()) continue;
+        if (i == 0) {
+            task = std::move(worker.queue.front());
+            worker.queue.pop_front();
+        } else {
+            task = std::move(worker.queue.back());
+            worker.queue.pop_back();
+        }
+    }
+    if (task) --queued;
+    return task;
+}
+
+void Scheduler::work(unsigned self) {
+    for (;;) {
+        if (auto task = take(self)) {
+            if (task->run()) schedule(std::move(task));
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        wake.wait(guard, [this] { return stopping || queued > 0; });
+        if (stopping && queued <= 0) return;
+    }
+}
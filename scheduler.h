@@ -0,0 +1,118 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Something a Scheduler runs. run() does a bounded amount of work and returns
+// true if the task has more to do and should be queued again.
+class Task {
+    friend class Scheduler;
+    static constexpr unsigned NO_HOME = ~0u;
+    unsigned home = NO_HOME; // Worker the task is pinned to, chosen when first scheduled
+
+public:
+    virtual ~Task() = default;
+    virtual bool run() = 0;
+};
+
+// A task with a mailbox. Messages are received one at a time, in the order
+// they were delivered, and an actor is queued at most once at a time, so
+// receive() never runs on two threads at once and the state an actor owns
+// needs no locking. Post messages with Scheduler::post.
+template <typename Message>
+class Actor : public Task {
+    // Messages handled per run before the actor yields its worker
+    static constexpr int BATCH = 16;
+
+    std::mutex lock; // Guards the mailbox only, never the actor's own state
+    // Messages from head on are waiting. Unlike a deque, an empty vector holds
+    // no memory, and the mailbox is released whenever it runs dry, so an idle
+    // actor costs only its own size.
+    std::vector<Message> mailbox;
+    std::size_t head = 0;
+    bool queued = false;
+
+protected:
+    virtual void receive(Message& message) = 0;
+
+public:
+    // Adds a message. Returns true if the actor was idle and needs scheduling.
+    bool deliver(Message message) {
+        std::lock_guard<std::mutex> guard(lock);
+        mailbox.push_back(std::move(message));
+        if (queued) return false;
+        queued = true;
+        return true;
+    }
+
+    bool run() override {
+        for (int n = 0; n < BATCH; ++n) {
+            Message message;
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (head == mailbox.size()) {
+                    std::vector<Message>().swap(mailbox);
+                    head = 0;
+                    queued = false;
+                    return false;
+                }
+                message = std::move(mailbox[head++]);
+            }
+            receive(message);
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        if (head == mailbox.size()) {
+            std::vector<Message>().swap(mailbox);
+            head = 0;
+            queued = false;
+        }
+        return queued;
+    }
+};
+
+// A work-stealing pool of worker threads. Each task is pinned to a home worker
+// (round robin) and queued there; a worker whose queue is empty steals from the
+// far end of another worker's queue, so bursts on a few tasks spread across
+// every core.
+class Scheduler {
+    struct Worker {
+        std::mutex lock;
+        std::deque<std::shared_ptr<Task>> queue;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<unsigned> next_home{0};
+
+    // Idle workers sleep here until something is queued
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::atomic<long> queued{0};
+    bool stopping = false;
+
+    std::shared_ptr<Task> take(unsigned self);
+    void work(unsigned self);
+
+public:
+    // threads == 0 uses one worker per core
+    explicit Scheduler(unsigned threads = 0);
+    // Finishes every queued task, then stops the workers
+    ~Scheduler();
+
+    void schedule(std::shared_ptr<Task> task);
+
+    template <typename Message>
+    void post(const std::shared_ptr<Actor<Message>>& actor, Message message) {
+        if (actor->deliver(std::move(message))) schedule(actor);
+    }
+
+    unsigned size() const;
+};
+
+#endif
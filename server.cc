@@ -0,0 +1,524 @@
+#include "server.h"
+#include "game.h"
+#include "scheduler.h"
+#include "events.h"
+#include "savefile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <malloc.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// A client that sends this much without a newline is dropped
+constexpr std::size_t MAX_LINE = 64 * 1024;
+// Stop reading from a client while this much output is waiting for it
+constexpr std::size_t MAX_PENDING_OUTPUT = 1024 * 1024;
+// Lines a client may have waiting in its games' mailboxes at once
+constexpr int MAX_INFLIGHT = 256;
+// Room set aside for a hibernating game's save, enough for a game with the
+// default deck and short player names (see savefile.h); a bigger save grows it
+constexpr std::size_t HIBERNATE_RESERVE = 192;
+
+std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+// Where a connection's games leave their replies for the epoll thread
+struct GameServer::Outbox {
+    const int fd;
+    std::mutex lock;
+    std::string out;
+    int inflight = 0;     // Lines handed to games but not yet run
+    bool flagged = false; // Already waiting in GameServer::ready
+
+    explicit Outbox(int fd) : fd(fd) {}
+};
+
+// A line for a game, or a nudge from the epoll thread to hibernate it
+struct GameServer::Message {
+    std::string text; // When hibernating, empty room for the save
+    bool hibernate = false;
+};
+
+// One hosted game. Lines are received as actor messages, or handled directly
+// over stdin/stdout.
+struct GameServer::Session : Actor<Message> {
+    GameServer& server;
+    const std::string id;
+    std::shared_ptr<Outbox> outbox; // Null over stdin/stdout
+
+    // While a game is awake. All null before the first line, after a game
+    // ends and while it hibernates.
+    std::unique_ptr<std::ostringstream> output;
+    std::unique_ptr<std::ostream> discard; // Where the game's text goes when sending events
+    std::unique_ptr<Game> game;
+
+    // A hibernating game: its save file's contents, or the number of the
+    // file it was spilled to
+    std::string blob;
+    std::uint64_t spill = 0;
+
+    // Owned by the epoll thread
+    std::chrono::steady_clock::time_point last_line;
+    bool hibernate_posted = false;
+
+    Session(GameServer& server, std::string id, std::shared_ptr<Outbox> outbox)
+        : server(server), id(std::move(id)), outbox(std::move(outbox)) {}
+    ~Session() {
+        if (spill) ::unlink(spillPath().c_str());
+    }
+
+    void open();
+    void close();
+    bool asleep() const { return spill != 0 || !blob.empty(); }
+    void hibernate(std::string room);
+    SaveData wake();
+    std::string spillPath() const;
+
+    void handle(const std::string& text, std::string& framed);
+    void receive(Message& message) override;
+};
+
+struct GameServer::Connection {
+    int fd;
+    std::string in;  // Bytes received but not yet run
+    std::string out; // Framed output not yet sent
+    unsigned events = EPOLLIN; // What epoll is watching for
+    bool eof = false;          // The client has finished sending
+    std::shared_ptr<Outbox> outbox;
+    std::unordered_map<std::string, std::shared_ptr<Session>> games;
+
+    explicit Connection(int fd) : fd(fd), outbox(std::make_shared<Outbox>(fd)) {}
+};
+
+// Creates the game and the streams it writes to
+void GameServer::Session::open() {
+    const ServerOptions& options = server.options;
+    output = std::make_unique<std::ostringstream>();
+    if (options.events) {
+        discard = std::make_unique<std::ostream>(nullptr);
+        game = std::make_unique<Game>(options.deck1_file, options.deck2_file, "", options.testing, false,
+                                      *discard, *discard);
+    } else {
+        game = std::make_unique<Game>(options.deck1_file, options.deck2_file, "", options.testing, false,
+                                      *output, *output);
+    }
+}
+
+void GameServer::Session::close() {
+    game.reset();
+    discard.reset();
+    output.reset();
+}
+
+std::string GameServer::Session::spillPath() const {
+    return server.options.hibernate_dir + "/sorcery-" + std::to_string(::getpid()) + "-" + std::to_string(spill) +
+           ".sav";
+}
+
+// Swaps an idle game for its save (see savefile.h), kept in memory or spilled
+// to a file. Games still taking player names stay awake.
+//
+// The room for the save comes from the epoll thread, which allocates it for
+// many games at once, packed together. Saved into the worker's own memory,
+// each would land in a gap left by some freed game, and the handful of bytes
+// would keep a whole page of it from going back to the system.
+void GameServer::Session::hibernate(std::string room) {
+    if (!game || !game->getActivePlayer() || game->isOver()) return;
+    std::string data;
+    try {
+        data = encodeSave(game->getSaveData());
+    } catch (const std::exception&) {
+        return; // A game that can't be saved (e.g. a name too long for it) stays awake
+    }
+    if (!server.options.hibernate_dir.empty()) {
+        static std::atomic<std::uint64_t> spills{0};
+        spill = ++spills;
+        std::ofstream file(spillPath(), std::ios::binary);
+        if (file.write(data.data(), data.size()) && file.flush()) {
+            close();
+            return;
+        }
+        ::unlink(spillPath().c_str());
+        spill = 0; // Keep it in memory instead
+    }
+    blob = std::move(room);
+    blob.assign(data);
+    close();
+}
+
+SaveData GameServer::Session::wake() {
+    if (spill) {
+        std::string path = spillPath();
+        spill = 0;
+        SaveData data = readSaveFile(path);
+        ::unlink(path.c_str());
+        return data;
+    }
+    std::string data;
+    data.swap(blob);
+    return decodeSave(data);
+}
+
+// Runs one line and appends what the game printed, framed with its id
+void GameServer::Session::handle(const std::string& text, std::string& framed) {
+    const ServerOptions& options = server.options;
+    bool ended;
+    try {
+        if (!game) {
+            bool waking = asleep();
+            open();
+            if (waking) {
+                game->restore(wake());
+            } else {
+                game->start();
+            }
+            // Subscribed after restoring, which would report every life and magic total
+            if (options.events) game->getEvents().subscribe(std::make_shared<JsonLinesSink>(*output));
+        }
+        game->resume(text);
+        ended = game->isOver();
+    } catch (const std::exception& e) {
+        // Only setup or waking up can get here (e.g. an unknown card in a
+        // deck, or a lost spill file); the game is unusable
+        if (options.events) {
+            JsonLinesSink(*output).onEvent({EventType::Error, 0, -1, CardId::Invalid, 0, 0, -1, e.what()});
+        } else {
+            *output << "Error: " << e.what() << std::endl;
+        }
+        ended = true;
+    }
+
+    // Swapping in a fresh buffer, unlike str(""), frees the old one's capacity
+    std::ostringstream drained;
+    drained.swap(*output);
+    std::string printed = drained.str();
+    std::size_t begin = 0;
+    while (begin < printed.size()) {
+        std::size_t end = printed.find('\n', begin);
+        if (end == std::string::npos) end = printed.size();
+        framed += id;
+        framed += ' ';
+        framed.append(printed, begin, end - begin);
+        framed += '\n';
+        begin = end + 1;
+    }
+
+    if (ended) {
+        framed += id + " :end\n";
+        close();
+    }
+}
+
+// Runs on a worker thread
+void GameServer::Session::receive(Message& message) {
+    if (message.hibernate) {
+        hibernate(std::move(message.text));
+        return;
+    }
+    std::string framed;
+    handle(message.text, framed);
+    bool wake;
+    {
+        std::lock_guard<std::mutex> guard(outbox->lock);
+        outbox->out += framed;
+        --outbox->inflight;
+        wake = !outbox->flagged;
+        outbox->flagged = true;
+    }
+    if (wake) server.outputReady(outbox);
+}
+
+GameServer::GameServer(ServerOptions options) : options(std::move(options)) {}
+
+GameServer::~GameServer() {
+    // Let running games finish before the state they report to goes away
+    scheduler.reset();
+    for (auto& entry : connections) ::close(entry.first);
+    if (ready_fd >= 0) ::close(ready_fd);
+}
+
+// Finds or starts the game a framed line is for. Returns null for a line
+// without an id.
+std::shared_ptr<GameServer::Session> GameServer::route(Connection& conn, std::string_view line, std::string& text) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    std::size_t space = line.find(' ');
+    std::string id(line.substr(0, space));
+    text = space == std::string_view::npos ? std::string() : std::string(line.substr(space + 1));
+    if (id.empty()) return nullptr;
+
+    auto& session = conn.games[id];
+    if (!session) session = std::make_shared<Session>(*this, id, conn.outbox);
+    session->last_line = std::chrono::steady_clock::now();
+    session->hibernate_posted = false;
+    return session;
+}
+
+// Called from workers when a game has left output in an outbox
+void GameServer::outputReady(const std::shared_ptr<Outbox>& outbox) {
+    {
+        std::lock_guard<std::mutex> guard(ready_lock);
+        ready.push_back(outbox);
+    }
+    std::uint64_t one = 1;
+    ssize_t written = ::write(ready_fd, &one, sizeof(one));
+    (void)written; // A full counter already means the epoll thread will wake
+}
+
+// Reads whatever the client has sent. Returns false on a socket error.
+bool GameServer::readFrom(Connection& conn) {
+    char buf[16 * 1024];
+    for (;;) {
+        ssize_t n = ::read(conn.fd, buf, sizeof(buf));
+        if (n > 0) {
+            conn.in.append(buf, n);
+        } else if (n == 0) {
+            conn.eof = true;
+            return true;
+        } else if (errno == EINTR) {
+            continue;
+        } else {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+    }
+}
+
+// Hands complete lines to their games until the client has a backlog of
+// output or of lines still running. Returns true if lines are left over.
+bool GameServer::runLines(Connection& conn) {
+    std::size_t begin = 0;
+    bool more = false;
+    for (;;) {
+        std::size_t end = conn.in.find('\n', begin);
+        if (end == std::string::npos) break;
+        if (conn.out.size() >= MAX_PENDING_OUTPUT) {
+            more = true;
+            break;
+        }
+        // Only this thread adds to inflight, so the check cannot go stale
+        {
+            std::lock_guard<std::mutex> guard(conn.outbox->lock);
+            more = conn.outbox->inflight >= MAX_INFLIGHT;
+        }
+        if (more) break;
+
+        std::string text;
+        if (auto session = route(conn, std::string_view(conn.in).substr(begin, end - begin), text)) {
+            {
+                std::lock_guard<std::mutex> guard(conn.outbox->lock);
+                ++conn.outbox->inflight;
+            }
+            scheduler->post<Message>(session, Message{std::move(text)});
+        }
+        begin = end + 1;
+    }
+    conn.in.erase(0, begin);
+    return more;
+}
+
+// Sends as much pending output as the socket takes. Returns false on error.
+bool GameServer::writeTo(Connection& conn) {
+    std::size_t sent = 0;
+    while (sent < conn.out.size()) {
+        ssize_t n = ::send(conn.fd, conn.out.data() + sent, conn.out.size() - sent, MSG_NOSIGNAL);
+        if (n >= 0) {
+            sent += n;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    conn.out.erase(0, sent);
+    if (conn.out.empty()) conn.out.shrink_to_fit();
+    return true;
+}
+
+// Takes whatever the connection's games have printed since the last call
+void GameServer::collect(Connection& conn) {
+    std::lock_guard<std::mutex> guard(conn.outbox->lock);
+    conn.outbox->flagged = false;
+    if (conn.outbox->out.empty()) return;
+    if (conn.out.empty()) {
+        conn.out.swap(conn.outbox->out);
+    } else {
+        conn.out += conn.outbox->out;
+        conn.outbox->out = std::string();
+    }
+}
+
+// Moves a connection along after an epoll event or new output from its
+// games. Returns false once it should be closed: on an error, or when a
+// client that has finished sending has had every reply.
+bool GameServer::service(Connection& conn, bool readable) {
+    if (readable && !conn.eof && !readFrom(conn)) return false;
+    collect(conn);
+    if (!writeTo(conn)) return false;
+    bool more = runLines(conn);
+    if (!more && conn.in.size() > MAX_LINE) return false;
+    if (!conn.eof || more || !conn.out.empty()) return true;
+    std::lock_guard<std::mutex> guard(conn.outbox->lock);
+    return conn.outbox->inflight > 0 || !conn.outbox->out.empty();
+}
+
+// Asks epoll for writability only while output is pending, and stops reading
+// from clients while they have a backlog
+void GameServer::watch(int epoll_fd, Connection& conn) {
+    unsigned events = 0;
+    if (!conn.eof && conn.out.size() < MAX_PENDING_OUTPUT && conn.in.find('\n') == std::string::npos) {
+        events |= EPOLLIN;
+    }
+    if (!conn.out.empty()) events |= EPOLLOUT;
+    if (events == conn.events) return;
+    conn.events = events;
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = conn.fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+void GameServer::serveSocket(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path is too long: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0) throw systemError("socket");
+    ::unlink(path.c_str());
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listener, SOMAXCONN) < 0) {
+        ::close(listener);
+        throw systemError("Could not listen on " + path);
+    }
+
+    int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    ready_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || ready_fd < 0) {
+        ::close(listener);
+        throw systemError("epoll_create1");
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listener;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listener, &ev);
+    ev.data.fd = ready_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ready_fd, &ev);
+
+    // Fixing the trim threshold stops the allocator raising it as games come
+    // and go, so the workers' arenas shrink back when their games hibernate
+    if (options.hibernate_after > 0) ::mallopt(M_TRIM_THRESHOLD, 128 * 1024);
+    scheduler = std::make_unique<Scheduler>(options.workers);
+
+    auto drop = [&](std::unordered_map<int, std::unique_ptr<Connection>>::iterator it) {
+        // Closing the socket also removes it from the epoll set. Games still
+        // running for the connection finish and their output is dropped.
+        ::close(it->first);
+        connections.erase(it);
+    };
+
+    // Idle games are looked for once a second, or more often for short timeouts
+    int timeout = -1;
+    if (options.hibernate_after > 0) timeout = static_cast<int>(std::min(1000.0, options.hibernate_after * 1000 / 2)) + 1;
+    auto next_scan = std::chrono::steady_clock::now();
+
+    epoll_event events[64];
+    std::vector<std::shared_ptr<Outbox>> woken;
+    for (;;) {
+        if (timeout >= 0 && std::chrono::steady_clock::now() >= next_scan) {
+            hibernateIdle();
+            next_scan = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+        }
+        int n = ::epoll_wait(epoll_fd, events, 64, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ::close(epoll_fd);
+            ::close(listener);
+            throw systemError("epoll_wait");
+        }
+        for (int k = 0; k < n; ++k) {
+            int fd = events[k].data.fd;
+            if (fd == listener) {
+                int client;
+                while ((client = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    connections.emplace(client, std::make_unique<Connection>(client));
+                    epoll_event cev{};
+                    cev.events = EPOLLIN;
+                    cev.data.fd = client;
+                    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client, &cev);
+                }
+            } else if (fd == ready_fd) {
+                std::uint64_t count;
+                while (::read(ready_fd, &count, sizeof(count)) > 0) {}
+                {
+                    std::lock_guard<std::mutex> guard(ready_lock);
+                    woken.swap(ready);
+                }
+                for (const auto& outbox : woken) {
+                    auto it = connections.find(outbox->fd);
+                    // The connection may have closed, and its socket been reused
+                    if (it == connections.end() || it->second->outbox != outbox) continue;
+                    if (service(*it->second, false)) watch(epoll_fd, *it->second);
+                    else drop(it);
+                }
+                woken.clear();
+            } else {
+                auto it = connections.find(fd);
+                if (it == connections.end()) continue;
+                bool readable = events[k].events & (EPOLLIN | EPOLLHUP | EPOLLERR);
+                if (service(*it->second, readable)) watch(epoll_fd, *it->second);
+                else drop(it);
+            }
+        }
+    }
+}
+
+// Asks every game idle for hibernate_after seconds to hibernate
+void GameServer::hibernateIdle() {
+    // Games freed since the last scan leave their memory in the allocator's
+    // per-thread arenas, where it counts against the process until trimmed
+    if (trim_due) ::malloc_trim(0);
+    trim_due = false;
+
+    auto cutoff = std::chrono::steady_clock::now() -
+                  std::chrono::duration<double>(options.hibernate_after);
+    for (auto& [fd, conn] : connections) {
+        for (auto& [id, session] : conn->games) {
+            if (session->hibernate_posted || session->last_line > cutoff) continue;
+            session->hibernate_posted = true;
+            Message message{"", true};
+            message.text.reserve(HIBERNATE_RESERVE);
+            scheduler->post<Message>(session, std::move(message));
+            trim_due = true;
+        }
+    }
+}
+
+void GameServer::serveStdio() {
+    Connection conn(STDOUT_FILENO);
+    std::string line;
+    std::string text;
+    while (std::getline(std::cin, line)) {
+        auto session = route(conn, line, text);
+        if (!session) continue;
+        std::string framed;
+        session->handle(text, framed);
+        std::cout << framed << std::flush;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+class Scheduler;
+
+// Hosts many games in one process. Clients connect over a Unix domain socket,
+// or a single client talks over stdin/stdout. Every line in either direction
+// is framed with a game id chosen by the client:
+//
+//     <game id> <line>
+//
+// A line for an unknown id starts a new game with that id. The game then takes
+// lines exactly as it would from a terminal, starting with the two player
+// names, and every line it prints comes back prefixed with its id. When a game
+// ends the server sends "<id> :end", and the next line for that id starts a
+// new game. Ids belong to the connection that created them, and a client's
+// games end when it disconnects.
+//
+// Sockets are multiplexed with epoll on one thread. Each game is an actor (see
+// scheduler.h) driving Game's resumable loop: its lines go to its mailbox and
+// it runs on a pool of worker threads, one at a time, so games proceed in
+// parallel without any locking inside Game or Player. The replies of each game
+// come back in order, but replies from different games may interleave. A game
+// only runs when a line arrives for it, so an idle game costs its memory and
+// nothing else. Over stdin/stdout, games run on the calling thread instead.
+//
+// With events set, a game's lines are its event stream (see events.h) instead
+// of the board and messages a terminal would show: one JSON object per line,
+// still framed with the game id.
+//
+// When serving a socket with hibernate_after set, a game that gets no line for
+// that many seconds is swapped for its save file's contents (see savefile.h),
+// about a hundred bytes, and restored when its next line arrives. Games are
+// only hibernated between turns' commands, not while taking player names.
+// With hibernate_dir set the saves go to files there instead of memory.
+struct ServerOptions {
+    std::string deck1_file = "default.deck";
+    std::string deck2_file = "default.deck";
+    bool testing = false;
+    unsigned workers = 0; // Threads running games; 0 is one per core
+    bool events = false;
+    double hibernate_after = 0; // Seconds; 0 never hibernates
+    std::string hibernate_dir;
+};
+
+class GameServer {
+    struct Outbox;
+    struct Message;
+    struct Session;
+    struct Connection;
+
+    ServerOptions options;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections; // By socket
+    std::unique_ptr<Scheduler> scheduler; // Only while serving a socket
+
+    // Outboxes with new output, and the eventfd that wakes the epoll thread for them
+    std::mutex ready_lock;
+    std::vector<std::shared_ptr<Outbox>> ready;
+    int ready_fd = -1;
+    bool trim_due = false; // Games have hibernated since memory was last trimmed
+
+    std::shared_ptr<Session> route(Connection& conn, std::string_view line, std::string& text);
+    void outputReady(const std::shared_ptr<Outbox>& outbox);
+    bool readFrom(Connection& conn);
+    bool runLines(Connection& conn);
+    bool writeTo(Connection& conn);
+    void collect(Connection& conn);
+    bool service(Connection& conn, bool readable);
+    void watch(int epoll_fd, Connection& conn);
+    void hibernateIdle();
+
+public:
+    explicit GameServer(ServerOptions options);
+    ~GameServer();
+
+    // Serves clients on a Unix socket at path, until the process is killed
+    void serveSocket(const std::string& path);
+    // Serves one client on stdin/stdout, until end of input
+    void serveStdio();
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include "solver.h"
+#include "actions.h"
+#include "game.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+// Scores are from the root player's side. A forced result is worth WIN plus
+// the turns left when it happens, so sooner wins and later losses score
+// higher, and a position's score depends only on its own subtree.
+constexpr int WIN = 1000000;
+constexpr int INF = 2 * WIN;
+// Depth counts turns, but a line recurses once per action, and nothing in
+// the rules caps the actions in a turn. Past this many the search scores
+// the position as it stands.
+constexpr int MAX_PLY = 128;
+
+enum Bound : std::uint8_t { Exact = 1, Lower, Upper };
+
+std::uint64_t hashPosition(const PackedState& position, int turns) {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    for (std::uint8_t byte : position.bytes) {
+        h ^= byte;
+        h *= 0x100000001b3ull;
+    }
+    h ^= static_cast<std::uint64_t>(turns) * 0x9e3779b97f4a7c15ull;
+    return h ? h : 1;
+}
+
+int sideTotal(Player& p) {
+    int total = 8 * p.getLife() + p.getMagic() + 2 * static_cast<int>(p.getHand().size());
+    for (const auto& m : p.getMinions()) {
+        if (m) total += 2 * (m->getAttack() + m->getDefense());
+    }
+    return total;
+}
+
+} // namespace
+
+int materialScore(Game& game, int player) {
+    return sideTotal(*game.getPlayer(player)) - sideTotal(*game.getPlayer(3 - player));
+}
+
+Solver::Solver(std::size_t entries) : scratch(std::make_unique<ScratchGame>()) {
+    std::size_t size = 1;
+    while (size * 2 <= entries) size *= 2;
+    table.resize(size);
+}
+
+Solver::~Solver() {}
+
+int Solver::evaluate(Game& game) const { return materialScore(game, root_player); }
+
+int Solver::search(const PackedState& position, int turns, int alpha, int beta, int ply, int* best) {
+    std::uint64_t key = hashPosition(position, turns);
+    Entry& entry = table[key & (table.size() - 1)];
+    int hint = -1;
+    if (entry.key == key) {
+        hint = entry.best;
+        // An exact root entry is left from an earlier solve (or ponder) that
+        // got this deep from here, and is as good as searching again
+        if (ply == 0 && entry.bound == Exact && entry.best >= 0) {
+            *best = entry.best;
+            return entry.value;
+        }
+        if (ply > 0) {
+            if (entry.bound == Exact) return entry.value;
+            if (entry.bound == Lower) alpha = std::max(alpha, entry.value);
+            if (entry.bound == Upper) beta = std::min(beta, entry.value);
+            if (alpha >= beta) return entry.value;
+        }
+    }
+
+    unpackState(position, *work);
+    if (ply >= MAX_PLY) return evaluate(*work);
+    bool maximizing = work->getActivePlayer()->getPlayerId() == root_player;
+
+    // The table's move first, then attacks on the opponent, ending the turn last
+    int moves[ACTION_COUNT];
+    int n = candidateActions(*work, moves);
+    auto rank = [hint](int a) { return a == hint ? 3 : a >= 66 && a < 71 ? 2 : a == ACTION_END ? 0 : 1; };
+    std::stable_sort(moves, moves + n, [&](int a, int b) { return rank(a) > rank(b); });
+
+    int alpha0 = alpha, beta0 = beta;
+    int value = maximizing ? -INF : INF;
+    int chosen = -1;
+    bool unpacked = true; // The scratch game still holds this position
+    for (int k = 0; k < n; ++k) {
+        int action = moves[k];
+        if (!unpacked) unpackState(position, *work);
+        unpacked = false;
+        try {
+            applyAction(*work, action);
+            work->removeDeadMinions();
+        } catch (const std::exception&) {
+            continue;
+        }
+        if ((++nodes & 15) == 0) {
+            if (std::chrono::steady_clock::now() >= deadline) stopped = true;
+            if (cancel && cancel->load(std::memory_order_relaxed)) stopped = true;
+        }
+        if (stopped) return 0;
+
+        int score;
+        if (int winner = work->getWinner()) {
+            score = winner == root_player ? WIN + turns : -WIN - turns;
+        } else if (action == ACTION_END && turns == 1) {
+            score = evaluate(*work);
+        } else {
+            PackedState child = packState(*work);
+            score = search(child, action == ACTION_END ? turns - 1 : turns, alpha, beta, ply + 1, nullptr);
+            if (stopped) return 0;
+        }
+
+        if (maximizing ? score > value : score < value) {
+            value = score;
+            chosen = action;
+        }
+        if (maximizing) alpha = std::max(alpha, value);
+        else beta = std::min(beta, value);
+        // Nothing beats winning this turn
+        if (alpha >= beta || std::abs(value) == WIN + turns) break;
+    }
+    // Every action failed, which "end" never does; score it as it stands
+    if (chosen < 0) {
+        unpackState(position, *work);
+        value = evaluate(*work);
+    }
+
+    entry.key = key;
+    entry.value = value;
+    entry.best = static_cast<std::int16_t>(chosen);
+    entry.bound = value <= alpha0 ? Upper : value >= beta0 ? Lower : Exact;
+    if (best) *best = chosen;
+    return value;
+}
+
+SolveResult Solver::solve(Game& game, int max_depth, double seconds,
+                          const std::function<void(const SolveResult&)>& progress) {
+    return solve(packState(game), game.getActivePlayer()->getPlayerId(), game.isTestingMode(), max_depth, seconds,
+                 progress);
+}
+
+void Solver::setCancelFlag(const std::atomic<bool>* flag) { cancel = flag; }
+
+SolveResult Solver::solve(const PackedState& root, int side, bool testing, int max_depth, double seconds,
+                          const std::function<void(const SolveResult&)>& progress) {
+    auto start = std::chrono::steady_clock::now();
+    deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                           std::chrono::duration<double>(seconds));
+    stopped = false;
+    nodes = 0;
+    root_player = side;
+    if (table_player != root_player) {
+        std::fill(table.begin(), table.end(), Entry{});
+        table_player = root_player;
+    }
+
+    // Unpacking replaces everything in the scratch game but the players
+    work = &scratch->get(testing);
+    unpackState(root, *work);
+    int mover = work->getActivePlayer()->getPlayerId();
+
+    SolveResult result;
+    for (int d = 1; d <= max_depth; ++d) {
+        int best = -1;
+        int value = search(root, d, -INF, INF, 0, &best);
+        if (stopped) break;
+
+        result.depth = d;
+        result.best = best;
+        result.outcome = (value > WIN ? 1 : value < -WIN ? -1 : 0) * (mover == side ? 1 : -1);
+        result.turns = result.outcome ? d - (std::abs(value) - WIN) + 1 : 0;
+        result.nodes = nodes;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (progress) progress(result);
+        if (result.outcome) break; // A deeper search finds the same result
+    }
+    result.nodes = nodes;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,92 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <vector>
+#include "packed.h"
+
+class Game;
+class ScratchGame;
+
+// --- Endgame solver ---
+// Iterative-deepening alpha-beta over the actions in actions.h, looking for a
+// forced win. Depth counts turns, the current one included: depth 1 asks
+// whether the player to move can win this turn, depth 3 whether they can win
+// by their next turn whatever the opponent does. A player makes any number of
+// moves in a turn, so the tree branches at every action but only deepens at
+// "end". Positions past the last turn are scored by a rough count of life and
+// material, which also orders the moves.
+//
+// Positions are copied by packing them (see packed.h) and unpacked into a
+// scratch game to try each move, so the game being solved is never touched.
+// The transposition table is keyed by a hash of the packed position and the
+// turns left, which also catches the many orders a turn's moves can be made
+// in. It is kept between solves from the same side, so a bot solving move
+// after move picks up where its last search left off.
+//
+// The deadline is checked every 16 nodes, so a search stops within a tenth of
+// a millisecond or so of it, keeping the best move of the last depth it
+// finished.
+struct SolveResult {
+    int depth = 0;   // Turns searched by the last completed iteration
+    int outcome = 0; // 1 if the player to move wins by force, -1 if they lose, 0 if neither within depth
+    int turns = 0;   // Turns until that result, counting the current one
+    int best = -1;   // Action to play (see actions.h), or -1 with no legal action
+    std::uint64_t nodes = 0;
+    double seconds = 0;
+};
+
+class Solver {
+    struct Entry {
+        std::uint64_t key = 0; // Position hash mixed with the turns left; 0 is empty
+        std::int32_t value = 0;
+        std::int16_t best = -1;
+        std::uint8_t bound = 0;
+    };
+
+    std::vector<Entry> table;
+    std::unique_ptr<ScratchGame> scratch; // Kept for the next solve
+    Game* work = nullptr; // The scratch game, while solving
+    int root_player = 0;
+    int table_player = 0; // The side the table's values are from, 0 while empty
+    std::uint64_t nodes = 0;
+    std::chrono::steady_clock::time_point deadline;
+    const std::atomic<bool>* cancel = nullptr;
+    bool stopped = false;
+
+    int search(const PackedState& position, int turns, int alpha, int beta, int ply, int* best);
+    int evaluate(Game& game) const;
+
+public:
+    // The table holds entries (rounded down to a power of two) of 16 bytes
+    explicit Solver(std::size_t entries = std::size_t{1} << 20);
+    ~Solver();
+
+    // Deepens a turn at a time up to max_depth turns or until seconds run
+    // out, calling progress after each completed iteration
+    SolveResult solve(Game& game, int max_depth, double seconds,
+                      const std::function<void(const SolveResult&)>& progress = nullptr);
+    // The same from a packed position, scored from side's point of view
+    // whoever is to move, with the result's outcome and best move for the
+    // player to move. Nothing here reads a Game, so a position packed on
+    // one thread can be solved on another, e.g. to think during the
+    // opponent's turn.
+    SolveResult solve(const PackedState& position, int side, bool testing, int max_depth, double seconds,
+                      const std::function<void(const SolveResult&)>& progress = nullptr);
+    // Another thread stops the search by setting flag, checked along with
+    // the deadline; the result is that of the last depth finished
+    void setCancelFlag(const std::atomic<bool>* flag);
+};
+
+// The rough count of life and material the solver scores positions by, from
+// player's side: 8 per life, 1 per magic, 2 per card in hand and 2 per point
+// of attack and defense on the board, less the same for the opponent
+int materialScore(Game& game, int player);
+
+#endif
@@ -0,0 +1,116 @@
+#include "sorcery_env.h"
+#include "observation.h"
+#include "actions.h"
+#include "game.h"
+#include "packed.h"
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+static_assert(SORCERY_OBS_SIZE == OBSERVATION_SIZE, "SORCERY_OBS_SIZE is out of date");
+static_assert(SORCERY_ACTION_COUNT == ACTION_COUNT, "SORCERY_ACTION_COUNT is out of date");
+
+namespace {
+
+thread_local std::string last_error;
+
+} // namespace
+
+struct SorceryEnv {
+    // Each slot keeps its game for every episode, dealing the next one into it
+    struct Slot {
+        std::unique_ptr<Game> game;
+        std::mt19937 seeds; // Seeds each new game in this slot
+        int steps = 0;
+        PackedState before; // The position before the last action, to undo it
+    };
+
+    std::vector<CardId> deck1;
+    std::vector<CardId> deck2;
+    int max_steps;
+    std::ostream discard{nullptr}; // The games' text output
+    std::vector<Slot> slots;
+
+    void newGame(Slot& slot) {
+        if (!slot.game) slot.game = std::make_unique<Game>("", "", "", false, false, discard, discard);
+        slot.game->seed(slot.seeds());
+        slot.game->deal(deck1, deck2);
+        slot.steps = 0;
+    }
+};
+
+extern "C" {
+
+SorceryEnv* sorcery_env_create(int n, const char* deck1, const char* deck2, uint32_t seed, int max_steps) {
+    try {
+        auto env = std::make_unique<SorceryEnv>();
+        env->deck1 = Player::readDeck(deck1 ? deck1 : "default.deck");
+        env->deck2 = Player::readDeck(deck2 ? deck2 : "default.deck");
+        env->max_steps = max_steps;
+        env->slots.resize(n > 0 ? n : 0);
+        for (int k = 0; k < n; ++k) {
+            env->slots[k].seeds.seed(seed + k);
+            env->newGame(env->slots[k]);
+        }
+        return env.release();
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return nullptr;
+    }
+}
+
+void sorcery_env_destroy(SorceryEnv* env) { delete env; }
+
+int sorcery_env_size(const SorceryEnv* env) { return env->slots.size(); }
+
+void sorcery_env_reset(SorceryEnv* env) {
+    for (auto& slot : env->slots) env->newGame(slot);
+}
+
+void sorcery_env_observe_f32(SorceryEnv* env, float* out) {
+    for (auto& slot : env->slots) {
+        encodeObservation(*slot.game, out);
+        out += SORCERY_OBS_SIZE;
+    }
+}
+
+void sorcery_env_observe_i32(SorceryEnv* env, int32_t* out) {
+    for (auto& slot : env->slots) {
+        encodeObservation(*slot.game, out);
+        out += SORCERY_OBS_SIZE;
+    }
+}
+
+void sorcery_env_step(SorceryEnv* env, const int32_t* actions, float* rewards, uint8_t* dones, uint8_t* illegal) {
+    for (size_t k = 0; k < env->slots.size(); ++k) {
+        auto& slot = env->slots[k];
+        Game& game = *slot.game;
+        int actor = game.getActivePlayer()->getPlayerId();
+
+        // An action can spend resources or partly apply its effect before it
+        // fails, so an illegal one is undone from a snapshot
+        packState(game, slot.before);
+        Rng::State rng = game.getRng().state();
+        bool failed = false;
+        try {
+            applyAction(game, actions[k]);
+            game.removeDeadMinions();
+        } catch (const std::exception&) {
+            failed = true;
+            unpackState(slot.before, game);
+            game.getRng().setState(rng);
+        }
+
+        int winner = game.getWinner();
+        bool done = winner != 0 || (env->max_steps > 0 && ++slot.steps >= env->max_steps);
+        if (rewards) rewards[k] = winner == 0 ? 0.0f : winner == actor ? 1.0f : -1.0f;
+        if (dones) dones[k] = done;
+        if (illegal) illegal[k] = failed;
+        if (done) env->newGame(slot);
+    }
+}
+
+const char* sorcery_last_error(void) { return last_error.c_str(); }
+
+} // extern "C"
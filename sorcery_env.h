@@ -0,0 +1,71 @@
+#ifndef SORCERY_ENV_H
+#define SORCERY_ENV_H
+
+/* C API for training agents: a batch of N independent games stepped together.
+ * Observations for the whole batch are written into one contiguous buffer of
+ * N * SORCERY_OBS_SIZE values supplied by the caller (see observation.h for
+ * the layout). The decks are read once, each game in the batch is kept and
+ * dealt again for its next episode, and the snapshot that undoes an illegal
+ * action reuses one buffer per game; what is still allocated is the cards
+ * themselves, made as they are drawn or come back from a snapshot. Build with
+ * 'make libsorcery.so'.
+ *
+ * Actions are integers in [0, SORCERY_ACTION_COUNT), played by the active
+ * player of each game. Indices i and j are 0-based hand or board slots, p is a
+ * player (1 or 2) and t a target slot, 5 being p's ritual:
+ *
+ *     0                          end turn
+ *     1 + i                      play i
+ *     6 + i*12 + (p-1)*6 + t     play i p t
+ *     66 + i                     attack i (the opponent)
+ *     71 + i*5 + j               attack i j
+ *     96 + i                     use i
+ *     101 + i*12 + (p-1)*6 + t   use i p t
+ *
+ * An illegal action is flagged and undone, leaving the game as it was even
+ * if it had already spent an action or partly applied an effect. A game that
+ * ends (a win, or max_steps actions without one) is flagged done and replaced
+ * by a fresh game before the step returns, so the next observation is that
+ * game's first position. The reward goes to the player who acted: 1 for a win,
+ * -1 for a loss, 0 otherwise.
+ *
+ * An environment must not be used from two threads at once; separate
+ * environments are independent. */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    SORCERY_OBS_SIZE = 119,
+    SORCERY_ACTION_COUNT = 161
+};
+
+typedef struct SorceryEnv SorceryEnv;
+
+/* Returns NULL on failure; sorcery_last_error() says why. Game k is shuffled
+ * with seed + k, so a batch is reproducible. max_steps 0 means no limit. */
+SorceryEnv* sorcery_env_create(int n, const char* deck1, const char* deck2, uint32_t seed, int max_steps);
+void sorcery_env_destroy(SorceryEnv* env);
+int sorcery_env_size(const SorceryEnv* env);
+
+/* Starts every game afresh */
+void sorcery_env_reset(SorceryEnv* env);
+
+/* Write n * SORCERY_OBS_SIZE values */
+void sorcery_env_observe_f32(SorceryEnv* env, float* out);
+void sorcery_env_observe_i32(SorceryEnv* env, int32_t* out);
+
+/* Applies actions[k] to game k. rewards, dones and illegal have n entries;
+ * any of them may be NULL. */
+void sorcery_env_step(SorceryEnv* env, const int32_t* actions, float* rewards, uint8_t* dones, uint8_t* illegal);
+
+const char* sorcery_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
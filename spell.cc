@@ -1,18 +1,25 @@
 #include "spell.h"
 #include "player.h"
 #include "game.h"
+#include "memstats.h"
 #include <stdexcept>
 
 Spell::Spell(const std::string& name, int cost, Player* owner, const std::string& desc,
-             bool req_target, std::function<void(Player*, Player*, int)> effect)
+             bool req_target, EffectProgram effect)
     : Card(name, cost, owner, CardType::Spell), description(desc), effect(effect), requires_target(req_target) {}
 
+Spell::Spell(const CardDef& def, Player* owner)
+    : Spell(def.name, def.cost, owner, def.desc, def.requiresTarget, def.effect) {
+    this->id = def.id;
+}
+
 // Play without a target
 void Spell::play(Player* p) {
     if (requires_target) {
         throw std::runtime_error("This spell requires a target.");
     }
-    effect(p, nullptr, -1);
+    MEM_CATEGORY(MemCategory::Spells);
+    runEffect(effect, {p, nullptr, -1, -1, false});
 }
 
 // Play with a target
@@ -20,10 +27,16 @@ void Spell::play(Player* p, Player* t, int i) {
     if (!requires_target) {
         throw std::runtime_error("This spell does not take a target.");
     }
-    effect(p, t, i);
+    MEM_CATEGORY(MemCategory::Spells);
+    runEffect(effect, {p, t, i, -1, false});
 }
 
 // Render the spell card
-card_template_t Spell::render() const {
-    return display_spell(name, cost, description);
+CardFace Spell::face() const {
+    CardFace f;
+    f.layout = CardFace::Layout::Spell;
+    f.name = name;
+    f.cost = cost;
+    f.desc = description;
+    return f;
 }
@@ -2,24 +2,34 @@
 #define SPELL_H
 
 #include "card.h"
-#include <functional>
+#include "cardtable.h"
 
 class Game;
 
 // Spell class, inherits from Card
 class Spell : public Card {
     std::string description;
-    // The spell's effect is a function
-    std::function<void(Player*, Player*, int)> effect; 
+    // The spell's effect is a bytecode program, run by the effect interpreter
+    EffectProgram effect;
     bool requires_target;
 
 public:
-    Spell(const std::string& name, int cost, Player* owner, const std::string& desc, 
-          bool req_target, std::function<void(Player*, Player*, int)> effect);
+    Spell(const std::string& name, int cost, Player* owner, const std::string& desc,
+          bool req_target, EffectProgram effect);
+    Spell(const CardDef& def, Player* owner);
 
     void play(Player* p) override;
     void play(Player* p, Player* t, int i) override;
-    card_template_t render() const override;
+    CardFace face() const override;
+};
+
+// A spell from CARD_TABLE, its definition looked up and checked at compile time
+template <CardId Id>
+class CardSpell final : public Spell {
+    static constexpr const CardDef& def = cardDef(Id);
+    static_assert(def.type == CardType::Spell, "Card is not a spell");
+public:
+    explicit CardSpell(Player* owner) : Spell(def, owner) {}
 };
 
 #endif
@@ -0,0 +1,217 @@
+#include "tournament.h"
+#include "bot.h"
+#include "game.h"
+#include "parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+constexpr double Z95 = 1.96;
+// Where the SPRT stops: log((1 - beta) / alpha) with both errors at 5%
+const double SPRT_BOUND = std::log(0.95 / 0.05);
+
+// Outcomes of a pair's games, from the first deck's side
+enum Outcome : signed char { Pending = -1, Draw, Win, Loss };
+
+struct Pair {
+    int first = 0;
+    int second = 0;
+    std::vector<signed char> outcomes; // By game number, Pending until played
+    Matchup counted; // The games played so far in order, up to the first gap
+    bool done = false;
+};
+
+// Game g of a pair has the first deck going first when g is even. Both seat
+// orders of a round share a seed.
+Outcome playGame(const TournamentOptions& options, const std::vector<std::vector<CardId>>& decks, const Pair& pair,
+                 int g, Game& game, GreedyBot& bot) {
+    bool swapped = g % 2;
+    game.seed(options.seed + g / 2);
+    game.deal(decks[swapped ? pair.second : pair.first], decks[swapped ? pair.first : pair.second]);
+    int winner = playOut(game, bot, options.max_turns);
+    if (!winner) return Draw;
+    return (winner == 1) != swapped ? Win : Loss;
+}
+
+// Bradley-Terry strengths by minorization-maximization, with a drawn game
+// added to every pair so a deck that wins or loses everything still gets a
+// finite rating
+std::vector<double> fitElo(const std::vector<std::vector<Matchup>>& matchups) {
+    std::size_t n = matchups.size();
+    std::vector<double> strength(n, 1.0);
+    for (int iteration = 0; iteration < 1000; ++iteration) {
+        std::vector<double> next(n);
+        double change = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            double won = 0, expected = 0;
+            for (std::size_t j = 0; j < n; ++j) {
+                if (i == j) continue;
+                const Matchup& m = matchups[i][j];
+                won += m.wins + 0.5 * m.draws + 0.5;
+                expected += (m.games + 1) / (strength[i] + strength[j]);
+            }
+            next[i] = expected > 0 ? won / expected : 1.0;
+        }
+        // Fix the geometric mean at 1, so the ratings average 0
+        double log_mean = 0;
+        for (double s : next) log_mean += std::log(s) / n;
+        for (std::size_t i = 0; i < n; ++i) {
+            next[i] /= std::exp(log_mean);
+            change = std::max(change, std::abs(std::log(next[i] / strength[i])));
+        }
+        strength = next;
+        if (change < 1e-9) break;
+    }
+    std::vector<double> elo(n);
+    for (std::size_t i = 0; i < n; ++i) elo[i] = 400 * std::log10(strength[i]);
+    return elo;
+}
+
+std::string deckName(const std::string& file) { return std::filesystem::path(file).stem().string(); }
+
+} // namespace
+
+double Matchup::score() const { return games ? (wins + 0.5 * draws) / games : 0.5; }
+
+double Matchup::margin() const {
+    if (!games) return 1;
+    double p = score(), n = games, z2 = Z95 * Z95;
+    return Z95 * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+}
+
+// A draw is half a win and half a loss, so draws cancel out
+double Matchup::llr(double delta) const { return (wins - losses) * std::log((0.5 + delta) / (0.5 - delta)); }
+
+TournamentResult runTournament(const TournamentOptions& options, std::ostream& out) {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t n = options.decks.size();
+    if (n < 2) throw std::runtime_error("A tournament needs at least two decks");
+    if (options.games < 1) throw std::runtime_error("A tournament needs at least one game per pair");
+    if (options.delta < 0 || options.delta >= 0.5) throw std::runtime_error("A tournament's delta must be under 0.5");
+    std::vector<std::vector<CardId>> decks;
+    for (const auto& deck : options.decks) decks.push_back(Player::readDeck(deck));
+
+    std::vector<Pair> pairs;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = i + 1; j < n; ++j) {
+            Pair p;
+            p.first = static_cast<int>(i);
+            p.second = static_cast<int>(j);
+            p.outcomes.assign(options.games, Pending);
+            pairs.push_back(std::move(p));
+        }
+    }
+
+    std::size_t width = 0;
+    for (const auto& deck : options.decks) width = std::max(width, deckName(deck).size());
+    std::mutex mutex; // Guards the pairs and the output
+    std::size_t finished = 0;
+    auto report = [&](const Pair& p) {
+        const Matchup& m = p.counted;
+        out << std::setw(width) << deckName(options.decks[p.first]) << " vs " << std::left << std::setw(width)
+            << deckName(options.decks[p.second]) << std::right << std::fixed << std::setprecision(1) << std::setw(7)
+            << m.score() * 100 << "% +-" << std::setw(4) << m.margin() * 100 << "  " << m.wins << '-' << m.losses
+            << '-' << m.draws << " in " << m.games << (m.games < options.games ? ", stopped early" : "") << " ("
+            << ++finished << '/' << pairs.size() << ')' << std::endl;
+        out.unsetf(std::ios::floatfield);
+    };
+
+    // Counts a pair's games in order as far as they go, stopping the pair
+    // once the SPRT decides or every game is in
+    auto record = [&](Pair& p, int g, Outcome outcome) {
+        p.outcomes[g] = outcome;
+        Matchup& m = p.counted;
+        while (!p.done && m.games < options.games && p.outcomes[m.games] != Pending) {
+            switch (p.outcomes[m.games++]) {
+            case Win: ++m.wins; break;
+            case Loss: ++m.losses; break;
+            default: ++m.draws; break;
+            }
+            bool decided = options.delta > 0 && m.games % 2 == 0 && std::abs(m.llr(options.delta)) >= SPRT_BOUND;
+            if (decided || m.games == options.games) {
+                p.done = true;
+                report(p);
+            }
+        }
+    };
+
+    // Round-robin over the pairs, a game each at a time, with a game and bot
+    // per thread, dealt again for every game
+    std::size_t jobs = pairs.size() * options.games;
+    unsigned threads = threadCount(options.threads, jobs);
+    std::vector<ScratchGame> scratch(threads);
+    std::vector<GreedyBot> bots(threads);
+    parallelFor(jobs, threads, [&](unsigned worker, std::size_t job) {
+        Pair& p = pairs[job % pairs.size()];
+        int g = static_cast<int>(job / pairs.size());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (p.done) return;
+        }
+        Outcome outcome = playGame(options, decks, p, g, scratch[worker].get(false), bots[worker]);
+        std::lock_guard<std::mutex> lock(mutex);
+        record(p, g, outcome);
+    });
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    TournamentResult result;
+    result.decks = options.decks;
+    result.matchups.assign(n, std::vector<Matchup>(n));
+    int games = 0;
+    for (const Pair& p : pairs) {
+        const Matchup& m = p.counted;
+        result.matchups[p.first][p.second] = m;
+        Matchup& mirror = result.matchups[p.second][p.first];
+        mirror.games = m.games;
+        mirror.wins = m.losses;
+        mirror.losses = m.wins;
+        mirror.draws = m.draws;
+        games += m.games;
+    }
+    result.elo = fitElo(result.matchups);
+
+    // The row deck's score against each column deck, then the decks by rating
+    out << "\nMatchups (row's score against column, %):\n" << std::setw(width + 4) << "";
+    for (std::size_t j = 0; j < n; ++j) out << std::setw(7) << j + 1;
+    out << '\n' << std::fixed << std::setprecision(1);
+    for (std::size_t i = 0; i < n; ++i) {
+        out << std::setw(3) << i + 1 << ' ' << std::left << std::setw(width) << deckName(options.decks[i])
+            << std::right;
+        for (std::size_t j = 0; j < n; ++j) {
+            if (i == j) out << std::setw(7) << '-';
+            else out << std::setw(7) << result.matchups[i][j].score() * 100;
+        }
+        out << '\n';
+    }
+
+    std::vector<std::size_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return result.elo[a] > result.elo[b];
+    });
+    out << "\nRatings:\n" << std::setw(3) << "" << ' ' << std::left << std::setw(width) << "deck" << std::right
+        << std::setw(7) << "elo" << std::setw(8) << "score" << std::setw(7) << "games" << '\n';
+    for (std::size_t i : order) {
+        Matchup total;
+        for (std::size_t j = 0; j < n; ++j) {
+            if (i == j) continue;
+            total.games += result.matchups[i][j].games;
+            total.wins += result.matchups[i][j].wins;
+            total.draws += result.matchups[i][j].draws;
+        }
+        out << std::setw(3) << i + 1 << ' ' << std::left << std::setw(width) << deckName(options.decks[i])
+            << std::right << std::showpos << std::setw(7) << std::setprecision(0) << result.elo[i] << std::noshowpos
+            << std::setw(7) << std::setprecision(1) << total.score() * 100 << '%' << std::setw(7) << total.games
+            << '\n';
+    }
+    out << games << " games in " << std::setprecision(3) << wall << "s on " << threads << " thread"
+        << (threads == 1 ? "" : "s") << std::endl;
+    out.unsetf(std::ios::floatfield);
+    return result;
+}
@@ -0,0 +1,61 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+// --- Tournament ---
+// Plays every pair of decks against each other with the greedy bot (see
+// bot.h) on both sides, alternating which deck goes first. Games are shared
+// out between threads a round at a time, so every pair makes progress
+// together, and each game is seeded by its number within the pair, so the
+// results don't depend on the number of threads.
+//
+// A pair stops early once a sequential probability ratio test (SPRT) says
+// which deck is ahead. It weighs "the first deck scores 0.5 + delta" against
+// "it scores 0.5 - delta", and stops when the evidence for either passes the
+// bound for a 5% chance of error each way. Checking a fixed-size confidence
+// interval after every game would stop on a lucky streak far more often than
+// 5% of the time; the SPRT's bounds are set for being checked after every
+// game, so they hold however often the pair is looked at. A pair whose true
+// score lies between the two may stop either way, and near-even pairs
+// usually play all their games. With delta at 0.1, a 60-40 matchup is
+// typically settled in about 40 games.
+//
+// Pairs are checked after each even number of games, so both seat orders
+// count equally. Games are only counted in order, so one that finishes after
+// its pair has stopped is dropped. Draws (games that run out of turns) count
+// as half a win each.
+struct TournamentOptions {
+    std::vector<std::string> decks;
+    int games = 100;      // Most games per pair
+    double delta = 0.1;   // 0 plays every pair to the end
+    int max_turns = 200;  // A game still going after this many is a draw
+    unsigned threads = 0; // 0 is one per core
+    unsigned seed = 1;
+};
+
+struct Matchup {
+    int games = 0;
+    int wins = 0; // For the first deck of the pair
+    int losses = 0;
+    int draws = 0;
+
+    double score() const; // Wins plus half the draws, per game
+    double margin() const; // Half width of the score's 95% confidence interval
+    // Log-likelihood ratio of a score of 0.5 + delta against 0.5 - delta
+    double llr(double delta) const;
+};
+
+struct TournamentResult {
+    std::vector<std::string> decks;
+    std::vector<std::vector<Matchup>> matchups; // [i][j] for deck i against deck j
+    std::vector<double> elo; // Fitted to every game, averaging 0
+};
+
+// Prints a line per pair as it finishes, then the matchup table and the
+// ratings. Throws if a deck can't be read.
+TournamentResult runTournament(const TournamentOptions& options, std::ostream& out);
+
+#endif
@@ -0,0 +1,156 @@
+#include "trace.h"
+#include "carddb.h"
+#include "events.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+struct Record {
+    const char* name;
+    std::uint64_t start;
+    std::uint64_t duration;
+    std::uint64_t track;
+    CardId card;
+    std::int8_t player;
+    std::int8_t slot;
+    std::int8_t target;
+    std::int8_t target_slot;
+    char detail[16];
+};
+
+std::mutex file_lock; // Guards everything below
+std::ofstream file;
+std::uint64_t epoch = 0; // Time 0 in the trace
+long pid = 0;
+
+std::atomic<unsigned> next_tid{1};
+
+// Chrome wants times in microseconds
+void writeMicros(std::ostream& out, std::uint64_t ns) {
+    out << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000 << std::setfill(' ');
+}
+
+void writeArgs(std::ostream& out, const Record& r) {
+    out << "\"args\":{\"player\":" << int{r.player};
+    if (r.slot >= 0) out << ",\"slot\":" << int{r.slot};
+    if (r.card != CardId::Invalid) {
+        out << ",\"card\":";
+        writeJsonString(out, CardDatabase::get(r.card).name);
+    }
+    if (r.target) {
+        out << ",\"target\":" << int{r.target};
+        if (r.target_slot >= 0) out << ",\"target_slot\":" << int{r.target_slot};
+    }
+    if (r.detail[0]) {
+        out << ",\"detail\":";
+        writeJsonString(out, r.detail);
+    }
+    out << '}';
+}
+
+// Spans on a track of their own are async events, a begin and an end
+void writeRecord(std::ostream& out, const Record& r, unsigned tid) {
+    out << "{\"name\":\"" << r.name << "\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":";
+    if (r.track) {
+        writeMicros(out, r.start - epoch);
+        out << ",\"ph\":\"b\",\"cat\":\"" << r.name << "\",\"id\":\"" << std::hex << r.track << std::dec << "\",";
+        writeArgs(out, r);
+        out << "},\n{\"name\":\"" << r.name << "\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":";
+        writeMicros(out, r.start + r.duration - epoch);
+        out << ",\"ph\":\"e\",\"cat\":\"" << r.name << "\",\"id\":\"" << std::hex << r.track << std::dec << "\"";
+    } else {
+        writeMicros(out, r.start - epoch);
+        out << ",\"ph\":\"X\",\"dur\":";
+        writeMicros(out, r.duration);
+        out << ',';
+        writeArgs(out, r);
+    }
+    out << "},\n";
+}
+
+// A thread's spans since its last write
+class Buffer {
+    static constexpr std::size_t CAPACITY = 4096;
+    std::vector<Record> records;
+    unsigned tid = next_tid++;
+
+public:
+    Buffer() { records.reserve(CAPACITY); }
+    ~Buffer() { flush(); }
+
+    void add(const Record& r) {
+        records.push_back(r);
+        if (records.size() == CAPACITY) flush();
+    }
+
+    // Formats outside the lock, then writes the lot at once
+    void flush() {
+        if (records.empty()) return;
+        std::ostringstream text;
+        for (const Record& r : records) writeRecord(text, r, tid);
+        records.clear();
+        std::lock_guard<std::mutex> guard(file_lock);
+        if (file.is_open()) file << text.str();
+    }
+};
+
+Buffer& local() {
+    thread_local Buffer buffer;
+    return buffer;
+}
+
+} // namespace
+
+namespace trace {
+
+std::atomic<bool> active{false};
+
+std::uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void start(const std::string& filename) {
+    std::lock_guard<std::mutex> guard(file_lock);
+    file.open(filename);
+    if (!file) throw std::runtime_error("Could not open trace file " + filename);
+    epoch = now();
+    pid = ::getpid();
+    file << "[\n";
+    active = true;
+}
+
+void stop() {
+    if (!active.exchange(false)) return;
+    local().flush();
+    std::lock_guard<std::mutex> guard(file_lock);
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"args\":{\"name\":\"sorcery\"}}\n]\n";
+    file.close();
+}
+
+void complete(const char* name, std::uint64_t start, const SpanArgs& args, std::uint64_t track) {
+    Record r;
+    r.name = name;
+    r.start = start;
+    r.duration = now() - start;
+    r.track = track;
+    r.card = args.card;
+    r.player = static_cast<std::int8_t>(args.player);
+    r.slot = static_cast<std::int8_t>(args.slot);
+    r.target = static_cast<std::int8_t>(args.target);
+    r.target_slot = static_cast<std::int8_t>(args.target_slot);
+    std::size_t n = std::min(args.detail.size(), sizeof(r.detail) - 1);
+    std::memcpy(r.detail, args.detail.data(), n);
+    r.detail[n] = '\0';
+    local().add(r);
+}
+
+} // namespace trace
@@ -0,0 +1,69 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "card.h"
+
+// --- Tracing ---
+// Spans of what the engine did and how long it took, written as Chrome
+// trace-event JSON for chrome://tracing or ui.perfetto.dev. There are spans
+// for each command, play, ability use and trigger fired, nested as they ran,
+// so a summon shows the Fire Elemental and Standstill triggers it set off
+// inside it. Turns are drawn on a track of their own per game, since a turn
+// starts and ends partway through 'end' commands.
+//
+// Spans carry the player and, where there is one, the card (by name) and its
+// slot: 0-4 on the board, 5 for a ritual, the hand index for a play. They are
+// kept in a buffer per thread and written in bulk when it fills or the
+// thread exits, so a span costs two clock reads while tracing and a relaxed
+// load otherwise.
+namespace trace {
+
+// Starts writing spans to a file. Throws if it can't be opened.
+void start(const std::string& filename);
+// Writes the calling thread's spans and finishes the file. Other threads must
+// have exited by then, or their last spans are lost.
+void stop();
+
+extern std::atomic<bool> active;
+inline bool enabled() { return active.load(std::memory_order_relaxed); }
+
+// Nanoseconds on the steady clock
+std::uint64_t now();
+
+struct SpanArgs {
+    int player = 0;
+    int slot = -1;
+    CardId card = CardId::Invalid;
+    int target = 0; // Target player, or 0
+    int target_slot = -1;
+    std::string_view detail = {}; // e.g. the command; only the first 15 bytes are kept
+};
+
+// Records a span that started at 'start' and ends now. A non-zero track puts
+// it on a track of its own rather than its thread's.
+void complete(const char* name, std::uint64_t start, const SpanArgs& args, std::uint64_t track = 0);
+
+// Times its own lifetime. 'name' must outlive the trace, e.g. a literal.
+class Span {
+    const char* name;
+    SpanArgs args;
+    std::uint64_t start = 0;
+
+public:
+    explicit Span(const char* name, SpanArgs args = {}) : name(name), args(args) {
+        if (enabled()) start = now();
+    }
+    ~Span() {
+        if (start) complete(name, start, args);
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+};
+
+} // namespace trace
+
+#endif